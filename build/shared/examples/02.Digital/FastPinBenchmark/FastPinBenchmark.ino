@@ -0,0 +1,83 @@
+/*
+ Fast Pin Benchmark
+
+ Measures how many clock cycles it takes to set an output pin with
+ digitalWrite(), digitalWriteFast() and a FastPin object on the board it
+ runs on, and prints the results to the serial monitor.
+
+ digitalWriteFast() and FastPin resolve a pin number that's a constant
+ at compile time, so they take only one or two cycles; with a pin number
+ that's only known when the sketch runs, digitalWriteFast() is the same
+ as digitalWrite().
+
+ The counter uses timer 1, so PWM on its pins is off while this runs.
+
+ The circuit:
+ * Built-in LED on pin 13 (it flickers too fast to see)
+
+ This example code is in the public domain.
+
+ */
+
+const int ledPin = LED_BUILTIN;           // a constant pin number
+volatile int runtimePin = LED_BUILTIN;    // the same pin, read when the sketch runs
+FastPin<LED_BUILTIN> led;
+
+const int calls = 100;
+unsigned long emptyLoop;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial) ;  // wait for the serial monitor on the Leonardo
+  pinMode(ledPin, OUTPUT);
+
+  startCycleCounter();
+
+  // the time taken by the loop itself, to leave out of the results
+  unsigned long start = cycleCount();
+  for (int i = 0; i < calls; i++) {
+    asm volatile ("");
+  }
+  emptyLoop = cycleCount() - start;
+
+  start = cycleCount();
+  for (int i = 0; i < calls; i++) {
+    digitalWrite(ledPin, HIGH);
+    digitalWrite(ledPin, LOW);
+  }
+  report("digitalWrite()", cycleCount() - start);
+
+  start = cycleCount();
+  for (int i = 0; i < calls; i++) {
+    digitalWriteFast(runtimePin, HIGH);
+    digitalWriteFast(runtimePin, LOW);
+  }
+  report("digitalWriteFast(), pin known at run time", cycleCount() - start);
+
+  start = cycleCount();
+  for (int i = 0; i < calls; i++) {
+    digitalWriteFast(ledPin, HIGH);
+    digitalWriteFast(ledPin, LOW);
+  }
+  report("digitalWriteFast(), constant pin", cycleCount() - start);
+
+  start = cycleCount();
+  for (int i = 0; i < calls; i++) {
+    led.high();
+    led.low();
+  }
+  report("FastPin", cycleCount() - start);
+
+  stopCycleCounter();
+}
+
+void loop() {
+}
+
+// prints the cycles taken by each of the 2 * calls writes
+void report(const char *name, unsigned long cycles) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float)(cycles - emptyLoop) / (2 * calls));
+  Serial.println(" cycles");
+}
@@ -0,0 +1,109 @@
+/*
+ Print Number Benchmark
+
+ Measures how many clock cycles print() takes to turn an unsigned long
+ into text in decimal, hexadecimal and binary, compares it with the way
+ print() used to do it (a 32-bit division for each digit, then write()
+ of the zero-terminated string), and prints the results to the serial
+ monitor.
+
+ The text goes to a Print that throws it away, so only the conversion
+ is timed, not the sending.
+
+ The counter uses timer 1, so PWM on its pins is off while this runs.
+
+ This example code is in the public domain.
+
+ */
+
+// a Print that discards everything written to it
+class NullPrint : public Print {
+  public:
+    size_t write(uint8_t c) { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) { return size; }
+};
+
+NullPrint sink;
+
+// small and large numbers, read when the sketch runs
+volatile unsigned long numbers[] = {
+  0, 7, 42, 1023, 65535, 123456, 2147483647UL, 4000000000UL
+};
+const int count = sizeof(numbers) / sizeof(numbers[0]);
+
+const int rounds = 10;
+unsigned long emptyLoop;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial) ;  // wait for the serial monitor on the Leonardo
+
+  startCycleCounter();
+
+  // the time taken by the loops themselves, to leave out of the results
+  unsigned long start = cycleCount();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < count; i++) {
+      unsigned long n = numbers[i];
+      asm volatile ("" : : "r" (n));
+    }
+  }
+  emptyLoop = cycleCount() - start;
+
+  compare("decimal", DEC);
+  compare("hexadecimal", HEX);
+  compare("binary", BIN);
+
+  stopCycleCounter();
+}
+
+void loop() {
+}
+
+// times print() and the old conversion on all the numbers in one base
+void compare(const char *name, uint8_t base) {
+  unsigned long start = cycleCount();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < count; i++) {
+      sink.print(numbers[i], base);
+    }
+  }
+  unsigned long now = cycleCount() - start;
+
+  start = cycleCount();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < count; i++) {
+      oldPrintNumber(sink, numbers[i], base);
+    }
+  }
+  unsigned long before = cycleCount() - start;
+
+  Serial.print(name);
+  Serial.print(": ");
+  report(now);
+  Serial.print(" cycles per number, ");
+  report(before);
+  Serial.println(" before");
+}
+
+// prints the cycles taken by each of the rounds * count conversions
+void report(unsigned long cycles) {
+  Serial.print((float)(cycles - emptyLoop) / (rounds * count));
+}
+
+// print(unsigned long, base) as it used to be
+size_t oldPrintNumber(Print &p, unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+
+  *str = '\0';
+
+  do {
+    unsigned long m = n;
+    n /= base;
+    char c = m - base * n;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+
+  return p.write(str);
+}
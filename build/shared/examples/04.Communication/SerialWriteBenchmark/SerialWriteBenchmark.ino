@@ -0,0 +1,71 @@
+/*
+ Serial Write Benchmark
+
+ Measures how many clock cycles per byte it takes to queue a line of
+ text for sending, with one call to Serial.write(buffer, size) and with
+ a call to Serial.write() for each byte, and prints the results to the
+ serial monitor.
+
+ The line is shorter than the transmit buffer (64 bytes on most boards)
+ and the buffer is emptied before each measurement, so only the copying
+ into the buffer is timed, not the wait for the bytes to go out.
+
+ On the Leonardo, Serial is the USB connection; use Serial1 instead to
+ measure the hardware serial port.
+
+ The counter uses timer 1, so PWM on its pins is off while this runs.
+
+ This example code is in the public domain.
+
+ */
+
+const char line[] = "The quick brown fox jumps over\r\n";
+const int size = sizeof(line) - 1;  // 32 bytes, without the zero at the end
+
+const int rounds = 10;
+unsigned long overhead;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) ;  // wait for the serial monitor on the Leonardo
+
+  startCycleCounter();
+
+  // the time taken by cycleCount() itself, to leave out of the results
+  unsigned long start = cycleCount();
+  overhead = cycleCount() - start;
+
+  unsigned long total = 0;
+  for (int r = 0; r < rounds; r++) {
+    Serial.flush();
+    start = cycleCount();
+    Serial.write((const uint8_t *)line, size);
+    total += cycleCount() - start;
+  }
+  report("write(buffer, size)", total);
+
+  total = 0;
+  for (int r = 0; r < rounds; r++) {
+    Serial.flush();
+    start = cycleCount();
+    for (int i = 0; i < size; i++) {
+      Serial.write((uint8_t)line[i]);
+    }
+    total += cycleCount() - start;
+  }
+  report("write() of each byte", total);
+
+  stopCycleCounter();
+}
+
+void loop() {
+}
+
+// prints the cycles taken by each of the rounds * size bytes
+void report(const char *name, unsigned long cycles) {
+  Serial.flush();
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float)(cycles - rounds * overhead) / ((long)rounds * size));
+  Serial.println(" cycles per byte");
+}
@@ -0,0 +1,55 @@
+/*
+ Memory Pool Test
+
+ Checks that new (pool) and new (arena) give NULL, instead of an object
+ at address 0, once a BlockPool or an Arena has run out of room, and
+ prints the results to the serial monitor.
+
+ Each allocator is filled until it returns NULL; the number of objects
+ that fitted must be the number there is room for.
+
+ This example code is in the public domain.
+
+ */
+
+#include <MemoryPool.h>
+
+struct Reading {
+  unsigned long time;
+  int value;
+  Reading() : time(millis()), value(analogRead(A0)) {}
+};
+
+const int capacity = 4;
+
+uint8_t poolMemory[capacity * sizeof(Reading)];
+uint8_t arenaMemory[capacity * sizeof(Reading)];
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial) ;  // wait for the serial monitor on the Leonardo
+
+  BlockPool pool(poolMemory, sizeof(poolMemory), sizeof(Reading));
+  int count = 0;
+  while (new (pool) Reading() != NULL && count <= capacity)
+    count++;
+  report("BlockPool", count);
+
+  Arena arena(arenaMemory, sizeof(arenaMemory));
+  count = 0;
+  while (new (arena) Reading() != NULL && count <= capacity)
+    count++;
+  report("Arena", count);
+}
+
+void loop() {
+}
+
+void report(const char *name, int count) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(count);
+  Serial.print(" of ");
+  Serial.print(capacity);
+  Serial.println(count == capacity ? " objects, then NULL: passed" : " objects: FAILED");
+}
@@ -119,11 +119,29 @@ void digitalWrite(uint8_t, uint8_t);
 int digitalRead(uint8_t);
 int analogRead(uint8_t);
 void analogReference(uint8_t mode);
+void analogPrescaler(uint8_t divisor);
 void analogWrite(uint8_t, int);
+// background sampling of a list of analog inputs (see wiring_adc.c)
+void startAnalogSampler(const uint8_t *pins, uint8_t count, unsigned long rate);
+void stopAnalogSampler(void);
+int analogSamplesAvailable(uint8_t index);
+int readAnalogSamples(uint8_t index, int *buffer, int length);
+unsigned int analogSamplerOverruns(void);
+// more than 10 bits by adding up 4^(bits - 10) readings (see wiring_adc.c)
+void startAnalogOversampling(uint8_t pin, uint8_t bits);
+long readAnalogOversampling(void);
+long analogReadOversampled(uint8_t pin, uint8_t bits);
 
 unsigned long millis(void);
 unsigned long micros(void);
+unsigned long long millis64(void);  // as millis() and micros(), but don't wrap around
+unsigned long long micros64(void);
+void startCycleCounter(void);  // counts clock cycles on timer 1 (see wiring_cycles.c)
+void stopCycleCounter(void);
+unsigned long cycleCount(void);
 void delay(unsigned long);
+void delaySleep(uint8_t enable);  // idle sleep during delay() (see wiring.c)
+void yield(void);  // called while delay() waits
 void delayMicroseconds(unsigned int us);
 unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout);
 
@@ -136,6 +154,21 @@ void detachInterrupt(uint8_t);
 void setup(void);
 void loop(void);
 
+// memory usage, in bytes (see wiring_memory.c)
+typedef struct {
+  size_t heapSize;          // from the start of the heap to its top, including freed blocks
+  size_t heapPeak;          // the largest the heap has been since startup
+  size_t freeMemory;        // between the heap and the stack, plus the freed blocks
+  size_t largestFreeBlock;  // the largest malloc() that would currently succeed
+  size_t stackSize;         // currently used by the stack
+  size_t stackPeak;         // the most the stack has used since startup
+} MemoryStats;
+
+MemoryStats memoryStats(void);
+// weak, so that main() only paints the free memory for memoryStats() when
+// the sketch uses it
+void paintFreeMemory(void) __attribute__((weak));
+
 // Get the bit location within the hardware port of the given virtual pin.
 // This comes from the pins_*.c file for the active board configuration.
 
@@ -231,4 +264,9 @@ long map(long, long, long, long, long);
 
 #include "pins_arduino.h"
 
+#ifdef __cplusplus
+#include "FastPin.h"
+#include "PinGroup.h"
+#endif
+
 #endif
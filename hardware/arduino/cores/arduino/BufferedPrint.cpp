@@ -0,0 +1,83 @@
+/*
+  BufferedPrint.cpp - Print adapter that groups small writes into bulk writes
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include "Arduino.h"
+#include "BufferedPrint.h"
+
+// Constructors ////////////////////////////////////////////////////////////////
+
+BufferedPrint::BufferedPrint(Print &target, uint8_t *buffer, size_t size)
+  : _target(target), _buffer(buffer), _size(size), _length(0), _flushOnNewline(true)
+{
+}
+
+BufferedPrint::~BufferedPrint()
+{
+  flush();
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+size_t BufferedPrint::write(uint8_t c)
+{
+  if (_length >= _size) {
+    flush();
+    // no buffer at all: pass the byte straight through
+    if (_size == 0) return _target.write(c);
+  }
+
+  _buffer[_length++] = c;
+
+  if (_length == _size || (c == '\n' && _flushOnNewline))
+    flush();
+  return 1;
+}
+
+size_t BufferedPrint::write(const uint8_t *buffer, size_t size)
+{
+  if (size == 0) return 0;
+
+  // data that wouldn't fit in an empty buffer goes to the target directly
+  if (size >= _size) {
+    flush();
+    size_t n = _target.write(buffer, size);
+    if (n < size) setWriteError();
+    return n;
+  }
+
+  if (size > _size - _length)
+    flush();
+
+  memcpy(_buffer + _length, buffer, size);
+  _length += size;
+
+  if (_length == _size || (_flushOnNewline && memchr(buffer, '\n', size)))
+    flush();
+  return size;
+}
+
+void BufferedPrint::flush(void)
+{
+  if (_length == 0) return;
+
+  if (_target.write(_buffer, _length) < _length)
+    setWriteError();
+  _length = 0;
+}
@@ -0,0 +1,57 @@
+/*
+  BufferedPrint.h - Print adapter that groups small writes into bulk writes
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BufferedPrint_h
+#define BufferedPrint_h
+
+#include <inttypes.h>
+#include "Print.h"
+
+// Collects everything printed to it in a buffer supplied by the caller and
+// passes it on to the target with a single write(buffer, size) when the
+// buffer is full, when a line ends (unless disabled with flushOnNewline())
+// or when flush() is called.  Useful in front of targets where every write
+// is a transaction of its own, e.g. network clients:
+//
+//   uint8_t buf[64];
+//   BufferedPrint out(client, buf, sizeof(buf));
+//   out.print(a); out.print(','); out.println(b);   // one packet
+
+class BufferedPrint : public Print
+{
+  private:
+    Print &_target;
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _length;
+    bool _flushOnNewline;
+  public:
+    BufferedPrint(Print &target, uint8_t *buffer, size_t size);
+    ~BufferedPrint();
+
+    virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    using Print::write; // pull in write(str) from Print
+
+    void flush(void);  // sends whatever is buffered to the target
+    void flushOnNewline(bool flush) { _flushOnNewline = flush; }
+    size_t buffered(void) { return _length; }  // number of bytes waiting
+};
+
+#endif
@@ -23,20 +23,35 @@
 #if defined(USBCON)
 #ifdef CDC_ENABLED
 
+#if !defined(SERIAL_BUFFER_SIZE)
 #if (RAMEND < 1000)
 #define SERIAL_BUFFER_SIZE 16
 #else
 #define SERIAL_BUFFER_SIZE 64
 #endif
+#endif
+
+// may be overridden at build time; must be a power of two (at most 256),
+// so that the indices wrap with a mask instead of a division
+#if !defined(CDC_RX_BUFFER_SIZE)
+#define CDC_RX_BUFFER_SIZE SERIAL_BUFFER_SIZE
+#endif
+
+#if (CDC_RX_BUFFER_SIZE < 2) || (CDC_RX_BUFFER_SIZE > 256) || (CDC_RX_BUFFER_SIZE & (CDC_RX_BUFFER_SIZE - 1))
+#error "CDC_RX_BUFFER_SIZE must be a power of two between 2 and 256"
+#endif
+
+#define CDC_RX_BUFFER_MASK (CDC_RX_BUFFER_SIZE - 1)
 
 struct ring_buffer
 {
-	unsigned char buffer[SERIAL_BUFFER_SIZE];
-	volatile int head;
-	volatile int tail;
+	unsigned char buffer[CDC_RX_BUFFER_SIZE];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	uint8_t peak;	// highest fill level seen by accept()
 };
 
-ring_buffer cdc_rx_buffer = { { 0 }, 0, 0};
+ring_buffer cdc_rx_buffer = { { 0 }, 0, 0, 0};
 
 typedef struct
 {
@@ -145,7 +160,7 @@ void Serial_::end(void)
 void Serial_::accept(void) 
 {
 	ring_buffer *buffer = &cdc_rx_buffer;
-	int i = (unsigned int)(buffer->head+1) % SERIAL_BUFFER_SIZE;
+	uint8_t i = (uint8_t)(buffer->head+1) & CDC_RX_BUFFER_MASK;
 	
 	// if we should be storing the received character into the location
 	// just before the tail (meaning that the head would advance to the
@@ -160,14 +175,18 @@ void Serial_::accept(void)
 		buffer->buffer[buffer->head] = c;
 		buffer->head = i;
 
-		i = (unsigned int)(buffer->head+1) % SERIAL_BUFFER_SIZE;
+		i = (uint8_t)(buffer->head+1) & CDC_RX_BUFFER_MASK;
 	}
+
+	uint8_t fill = (uint8_t)(buffer->head - buffer->tail) & CDC_RX_BUFFER_MASK;
+	if (fill > buffer->peak)
+		buffer->peak = fill;
 }
 
 int Serial_::available(void)
 {
 	ring_buffer *buffer = &cdc_rx_buffer;
-	return (unsigned int)(SERIAL_BUFFER_SIZE + buffer->head - buffer->tail) % SERIAL_BUFFER_SIZE;
+	return (uint8_t)(buffer->head - buffer->tail) & CDC_RX_BUFFER_MASK;
 }
 
 int Serial_::peek(void)
@@ -188,11 +207,63 @@ int Serial_::read(void)
 		return -1;
 	} else {
 		unsigned char c = buffer->buffer[buffer->tail];
-		buffer->tail = (unsigned int)(buffer->tail + 1) % SERIAL_BUFFER_SIZE;
+		buffer->tail = (uint8_t)(buffer->tail + 1) & CDC_RX_BUFFER_MASK;
 		return c;
 	}	
 }
 
+int Serial_::read(uint8_t *buffer, size_t length)
+{
+	size_t count = 0;
+	while (count < length) {
+		const uint8_t *data;
+		size_t n = peekBuffer(&data);
+		if (n == 0)
+			break;
+		if (n > length - count)
+			n = length - count;
+		memcpy(buffer + count, data, n);
+		consume(n);
+		count += n;
+	}
+	return count;
+}
+
+size_t Serial_::peekBuffer(const uint8_t **data)
+{
+	ring_buffer *buffer = &cdc_rx_buffer;
+	uint8_t head = buffer->head;
+	uint8_t tail = buffer->tail;
+
+	*data = buffer->buffer + tail;
+	if (head >= tail)
+		return head - tail;
+	return CDC_RX_BUFFER_SIZE - tail;
+}
+
+void Serial_::consume(size_t n)
+{
+	ring_buffer *buffer = &cdc_rx_buffer;
+	size_t count = available();
+	if (n > count)
+		n = count;
+	buffer->tail = (uint8_t)(buffer->tail + n) & CDC_RX_BUFFER_MASK;
+}
+
+// USB flow control keeps unread data in the endpoint while the buffer is
+// full, so nothing is ever dropped and there are no line errors to count
+SerialStats Serial_::stats()
+{
+	SerialStats stats = { 0, 0, 0, 0, 0 };
+	stats.maxAvailable = cdc_rx_buffer.peak;
+	return stats;
+}
+
+void Serial_::resetStats()
+{
+	cdc_rx_buffer.peak = 0;
+}
+
 void Serial_::flush(void)
 {
 	USB_Flush(CDC_TX);
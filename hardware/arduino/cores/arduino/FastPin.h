@@ -0,0 +1,164 @@
+/*
+  FastPin.h - digital I/O on pins known at compile time
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef FastPin_h
+#define FastPin_h
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+// digitalWrite() and friends look up the pin's port and bit in flash and
+// check for PWM every time they're called.  When the pin number is a
+// constant, the fast versions below look it up at compile time instead
+// (from the variant's digitalPinToPortLetter() and digitalPinToBit()) and
+// compile to a single sbi, cbi or sbic instruction.  For a pin number
+// that's only known at run time, or on a variant without those macros,
+// they just call the normal functions.
+//
+// Unlike digitalWrite(), digitalWriteFast() on a constant pin doesn't turn
+// off PWM on it: call digitalWrite() or pinMode() first if analogWrite()
+// was used on the pin.
+
+// the input register (PINx) of a port is followed by DDRx and PORTx
+#define FASTPIN_PIN 0
+#define FASTPIN_DDR 1
+#define FASTPIN_PORT 2
+
+#if defined(digitalPinToPortLetter) && defined(digitalPinToBit)
+
+static inline volatile uint8_t *fastPinRegister(char port, uint8_t offset) __attribute__((always_inline));
+static inline volatile uint8_t *fastPinRegister(char port, uint8_t offset)
+{
+  volatile uint8_t *reg = 0;
+#ifdef PINA
+  if (port == 'A') reg = &PINA;
+#endif
+#ifdef PINB
+  if (port == 'B') reg = &PINB;
+#endif
+#ifdef PINC
+  if (port == 'C') reg = &PINC;
+#endif
+#ifdef PIND
+  if (port == 'D') reg = &PIND;
+#endif
+#ifdef PINE
+  if (port == 'E') reg = &PINE;
+#endif
+#ifdef PINF
+  if (port == 'F') reg = &PINF;
+#endif
+#ifdef PING
+  if (port == 'G') reg = &PING;
+#endif
+#ifdef PINH
+  if (port == 'H') reg = &PINH;
+#endif
+#ifdef PINJ
+  if (port == 'J') reg = &PINJ;
+#endif
+#ifdef PINK
+  if (port == 'K') reg = &PINK;
+#endif
+#ifdef PINL
+  if (port == 'L') reg = &PINL;
+#endif
+  return reg + offset;
+}
+
+// sets or clears a bit of a port register.  in the low I/O space that's a
+// single instruction; above it (ports H to L on the Mega) it takes a read-
+// modify-write that an interrupt mustn't get into the middle of.
+static inline void fastPinWriteBit(volatile uint8_t *reg, uint8_t bit, uint8_t val) __attribute__((always_inline));
+static inline void fastPinWriteBit(volatile uint8_t *reg, uint8_t bit, uint8_t val)
+{
+  if ((uintptr_t)reg < 0x20 + __SFR_OFFSET) {
+    if (val) *reg |= _BV(bit);
+    else *reg &= ~_BV(bit);
+  } else {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (val) *reg |= _BV(bit);
+    else *reg &= ~_BV(bit);
+    SREG = oldSREG;
+  }
+}
+
+#define fastPinIsConstant(pin) (__builtin_constant_p(pin) && (pin) < NUM_DIGITAL_PINS)
+#define fastPinRegisterOf(pin, offset) fastPinRegister(digitalPinToPortLetter(pin), offset)
+#define fastPinBit(pin) digitalPinToBit(pin)
+
+#else
+
+#define fastPinIsConstant(pin) 0
+#define fastPinRegisterOf(pin, offset) ((volatile uint8_t *)0)
+#define fastPinWriteBit(reg, bit, val) ((void)0)
+#define fastPinBit(pin) 0
+
+#endif
+
+static inline void digitalWriteFast(uint8_t pin, uint8_t val) __attribute__((always_inline));
+static inline void digitalWriteFast(uint8_t pin, uint8_t val)
+{
+  if (fastPinIsConstant(pin))
+    fastPinWriteBit(fastPinRegisterOf(pin, FASTPIN_PORT), fastPinBit(pin), val != LOW);
+  else
+    digitalWrite(pin, val);
+}
+
+static inline int digitalReadFast(uint8_t pin) __attribute__((always_inline));
+static inline int digitalReadFast(uint8_t pin)
+{
+  if (fastPinIsConstant(pin))
+    return (*fastPinRegisterOf(pin, FASTPIN_PIN) & _BV(fastPinBit(pin))) ? HIGH : LOW;
+  return digitalRead(pin);
+}
+
+static inline void pinModeFast(uint8_t pin, uint8_t mode) __attribute__((always_inline));
+static inline void pinModeFast(uint8_t pin, uint8_t mode)
+{
+  if (fastPinIsConstant(pin) && __builtin_constant_p(mode)) {
+    // in the same order as pinMode(), so an input never drives the pin
+    fastPinWriteBit(fastPinRegisterOf(pin, FASTPIN_DDR), fastPinBit(pin), mode == OUTPUT);
+    if (mode != OUTPUT)
+      fastPinWriteBit(fastPinRegisterOf(pin, FASTPIN_PORT), fastPinBit(pin), mode == INPUT_PULLUP);
+  } else {
+    pinMode(pin, mode);
+  }
+}
+
+// The same operations on a pin given as a template argument, which is
+// always a constant:
+//
+//   FastPin<13> led;
+//   led.output();
+//   led.high();
+template <uint8_t pin> class FastPin
+{
+  public:
+    static void output(void) { pinModeFast(pin, OUTPUT); }
+    static void input(void) { pinModeFast(pin, INPUT); }
+    static void inputPullup(void) { pinModeFast(pin, INPUT_PULLUP); }
+    static void high(void) { digitalWriteFast(pin, HIGH); }
+    static void low(void) { digitalWriteFast(pin, LOW); }
+    static void write(uint8_t val) { digitalWriteFast(pin, val); }
+    static int read(void) { return digitalReadFast(pin); }
+};
+
+#endif
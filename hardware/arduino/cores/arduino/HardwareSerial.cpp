@@ -49,47 +49,237 @@
 #endif
 #endif
 
+// the error flags have the same position in the status register of every
+// uart, so the receive code uses the uart 0 names for all of them
+#if !defined(UPE0)
+#if defined(UPE)
+#define UPE0 UPE
+#elif defined(PE)
+#define UPE0 PE
+#elif defined(UPE1)
+#define UPE0 UPE1
+#endif
+#endif
+#if !defined(FE0)
+#if defined(FE)
+#define FE0 FE
+#elif defined(FE1)
+#define FE0 FE1
+#endif
+#endif
+#if !defined(DOR0)
+#if defined(DOR)
+#define DOR0 DOR
+#elif defined(DOR1)
+#define DOR0 DOR1
+#endif
+#endif
+#if !defined(U2X0)
+#if defined(U2X)
+#define U2X0 U2X
+#elif defined(U2X1)
+#define U2X0 U2X1
+#endif
+#endif
+#if !defined(UDRE0)
+#if defined(UDRE)
+#define UDRE0 UDRE
+#elif defined(UDRE1)
+#define UDRE0 UDRE1
+#endif
+#endif
+#if !defined(MPCM0)
+#if defined(MPCM)
+#define MPCM0 MPCM
+#elif defined(MPCM1)
+#define MPCM0 MPCM1
+#endif
+#endif
+#if !defined(RXB80)
+#if defined(RXB8)
+#define RXB80 RXB8
+#elif defined(RXB81)
+#define RXB80 RXB81
+#endif
+#endif
+#if !defined(TXB80)
+#if defined(TXB8)
+#define TXB80 TXB8
+#elif defined(TXB81)
+#define TXB80 TXB81
+#endif
+#endif
+#if !defined(UCSZ02)
+#if defined(UCSZ2)
+#define UCSZ02 UCSZ2
+#elif defined(UCSZ12)
+#define UCSZ02 UCSZ12
+#endif
+#endif
+
 // Define constants and variables for buffering incoming serial data.  We're
 // using a ring buffer (I think), in which head is the index of the location
 // to which to write the next incoming character and tail is the index of the
 // location from which to read.
+//
+// The receive and transmit buffer sizes can be chosen at build time, either
+// for all ports (SERIAL_RX_BUFFER_SIZE, SERIAL_TX_BUFFER_SIZE) or for a single
+// port (e.g. SERIAL1_RX_BUFFER_SIZE), on the compiler command line or in the
+// variant's pins_arduino.h.  Sizes must be powers of two, so that the indices
+// wrap with a mask instead of a division.
+#if !defined(SERIAL_BUFFER_SIZE)
 #if (RAMEND < 1000)
   #define SERIAL_BUFFER_SIZE 16
 #else
   #define SERIAL_BUFFER_SIZE 64
 #endif
+#endif
+
+#if !defined(SERIAL_RX_BUFFER_SIZE)
+  #define SERIAL_RX_BUFFER_SIZE SERIAL_BUFFER_SIZE
+#endif
+#if !defined(SERIAL_TX_BUFFER_SIZE)
+  #define SERIAL_TX_BUFFER_SIZE SERIAL_BUFFER_SIZE
+#endif
+
+#if !defined(SERIAL0_RX_BUFFER_SIZE)
+  #define SERIAL0_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL0_TX_BUFFER_SIZE)
+  #define SERIAL0_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_RX_BUFFER_SIZE)
+  #define SERIAL1_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_TX_BUFFER_SIZE)
+  #define SERIAL1_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_RX_BUFFER_SIZE)
+  #define SERIAL2_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_TX_BUFFER_SIZE)
+  #define SERIAL2_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_RX_BUFFER_SIZE)
+  #define SERIAL3_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_TX_BUFFER_SIZE)
+  #define SERIAL3_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+
+#define SERIAL_IS_POWER_OF_TWO(n) ((n) >= 2 && ((n) & ((n) - 1)) == 0)
+
+#if !SERIAL_IS_POWER_OF_TWO(SERIAL0_RX_BUFFER_SIZE) || !SERIAL_IS_POWER_OF_TWO(SERIAL0_TX_BUFFER_SIZE) || \
+    !SERIAL_IS_POWER_OF_TWO(SERIAL1_RX_BUFFER_SIZE) || !SERIAL_IS_POWER_OF_TWO(SERIAL1_TX_BUFFER_SIZE) || \
+    !SERIAL_IS_POWER_OF_TWO(SERIAL2_RX_BUFFER_SIZE) || !SERIAL_IS_POWER_OF_TWO(SERIAL2_TX_BUFFER_SIZE) || \
+    !SERIAL_IS_POWER_OF_TWO(SERIAL3_RX_BUFFER_SIZE) || !SERIAL_IS_POWER_OF_TWO(SERIAL3_TX_BUFFER_SIZE)
+  #error "Serial buffer sizes must be powers of two"
+#endif
+
+// byte-sized indices are enough (and much cheaper to update from the
+// interrupt handlers) as long as no buffer is larger than 256 bytes
+#if (SERIAL0_RX_BUFFER_SIZE > 256) || (SERIAL0_TX_BUFFER_SIZE > 256) || \
+    (SERIAL1_RX_BUFFER_SIZE > 256) || (SERIAL1_TX_BUFFER_SIZE > 256) || \
+    (SERIAL2_RX_BUFFER_SIZE > 256) || (SERIAL2_TX_BUFFER_SIZE > 256) || \
+    (SERIAL3_RX_BUFFER_SIZE > 256) || (SERIAL3_TX_BUFFER_SIZE > 256)
+typedef uint16_t ring_index_t;
+#else
+typedef uint8_t ring_index_t;
+#endif
+
+struct rx_ring_buffer
+{
+  unsigned char *buffer;
+  ring_index_t mask;  // buffer size - 1
+  volatile ring_index_t head;
+  volatile ring_index_t tail;
+
+  // receive statistics, only updated by the receive interrupt handlers
+  ring_index_t peak;
+  uint16_t dropped;
+  uint16_t overruns;
+  uint16_t parity_errors;
+  uint16_t frame_errors;
+
+#if SERIAL_FLOW_CONTROL
+  // RTS flow control, off while rts_reg is 0: the output register of the
+  // RTS pin, which is driven high once rts_threshold bytes are waiting
+  volatile uint8_t *rts_reg;
+  uint8_t rts_mask;
+  ring_index_t rts_threshold;
+#endif
+
+#if SERIAL_MULTIPROCESSOR
+  // 9-bit multiprocessor mode: when mpcm is set only the data following an
+  // address frame for mpcm_address is received
+  bool mpcm;
+  uint8_t mpcm_address;
+#endif
+};
 
-struct ring_buffer
+struct tx_ring_buffer
 {
-  unsigned char buffer[SERIAL_BUFFER_SIZE];
-  volatile unsigned int head;
-  volatile unsigned int tail;
+  unsigned char *buffer;
+  ring_index_t mask;  // buffer size - 1
+  volatile ring_index_t head;
+  volatile ring_index_t tail;
+
+#if SERIAL_FLOW_CONTROL
+  // CTS flow control, off while cts_reg is 0: the input register of the
+  // CTS pin; nothing is sent while that pin is high
+  volatile uint8_t *cts_reg;
+  uint8_t cts_mask;
+#endif
 };
 
+#define RING_BUFFER(type, name, size) \
+  static unsigned char name##_data[size]; \
+  type name = { name##_data, (size) - 1, 0, 0 }
+
 #if defined(USBCON)
-  ring_buffer rx_buffer = { { 0 }, 0, 0};
-  ring_buffer tx_buffer = { { 0 }, 0, 0};
+  RING_BUFFER(rx_ring_buffer, rx_buffer, SERIAL0_RX_BUFFER_SIZE);
+  RING_BUFFER(tx_ring_buffer, tx_buffer, SERIAL0_TX_BUFFER_SIZE);
 #endif
 #if defined(UBRRH) || defined(UBRR0H)
-  ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_ring_buffer, rx_buffer, SERIAL0_RX_BUFFER_SIZE);
+  RING_BUFFER(tx_ring_buffer, tx_buffer, SERIAL0_TX_BUFFER_SIZE);
 #endif
 #if defined(UBRR1H)
-  ring_buffer rx_buffer1  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer1  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_ring_buffer, rx_buffer1, SERIAL1_RX_BUFFER_SIZE);
+  RING_BUFFER(tx_ring_buffer, tx_buffer1, SERIAL1_TX_BUFFER_SIZE);
 #endif
 #if defined(UBRR2H)
-  ring_buffer rx_buffer2  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer2  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_ring_buffer, rx_buffer2, SERIAL2_RX_BUFFER_SIZE);
+  RING_BUFFER(tx_ring_buffer, tx_buffer2, SERIAL2_TX_BUFFER_SIZE);
 #endif
 #if defined(UBRR3H)
-  ring_buffer rx_buffer3  =  { { 0 }, 0, 0 };
-  ring_buffer tx_buffer3  =  { { 0 }, 0, 0 };
+  RING_BUFFER(rx_ring_buffer, rx_buffer3, SERIAL3_RX_BUFFER_SIZE);
+  RING_BUFFER(tx_ring_buffer, tx_buffer3, SERIAL3_TX_BUFFER_SIZE);
 #endif
 
-inline void store_char(unsigned char c, ring_buffer *buffer)
+// an index that is updated from an interrupt handler can only be read in
+// one piece from the main program if it is a single byte
+inline ring_index_t atomic_index(volatile ring_index_t *index)
 {
-  int i = (unsigned int)(buffer->head + 1) % SERIAL_BUFFER_SIZE;
+  if (sizeof(ring_index_t) == 1)
+    return *index;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  ring_index_t i = *index;
+  SREG = oldSREG;
+  return i;
+}
+
+inline void count_error(uint16_t *counter)
+{
+  if (*counter != 0xFFFF)
+    (*counter)++;
+}
+
+inline void store_char(unsigned char c, rx_ring_buffer *buffer)
+{
+  ring_index_t i = (ring_index_t)(buffer->head + 1) & buffer->mask;
 
   // if we should be storing the received character into the location
   // just before the tail (meaning that the head would advance to the
@@ -98,9 +288,77 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
   if (i != buffer->tail) {
     buffer->buffer[buffer->head] = c;
     buffer->head = i;
+
+    ring_index_t fill = (ring_index_t)(i - buffer->tail) & buffer->mask;
+    if (fill > buffer->peak)
+      buffer->peak = fill;
+
+#if SERIAL_FLOW_CONTROL
+    // ask the other side to stop sending before the buffer overflows
+    if (buffer->rts_reg && fill >= buffer->rts_threshold)
+      *buffer->rts_reg |= buffer->rts_mask;
+#endif
+  } else {
+    count_error(&buffer->dropped);
   }
 }
 
+// true if the other side has deasserted CTS, so transmission must pause
+inline bool tx_paused(tx_ring_buffer *buffer)
+{
+#if SERIAL_FLOW_CONTROL
+  return buffer->cts_reg && (*buffer->cts_reg & buffer->cts_mask);
+#else
+  return false;
+#endif
+}
+
+#if SERIAL_MULTIPROCESSOR
+// writes the MPCM bit, leaving U2X alone; TXC is cleared by writing a one
+// and the error flags must be written as zero, so no read-modify-write
+inline void set_mpcm(volatile uint8_t *ucsra, bool on)
+{
+  *ucsra = (*ucsra & _BV(U2X0)) | (on ? _BV(MPCM0) : 0);
+}
+#endif
+
+// handles a received character.  the status and control registers are
+// read before the data register, since reading that clears the error
+// flags and the 9th bit.  inlined into each interrupt handler, so the
+// registers are accessed directly.
+inline void receive_char(rx_ring_buffer *buffer, volatile uint8_t *ucsra,
+  volatile uint8_t *ucsrb, volatile uint8_t *udr) __attribute__((always_inline));
+inline void receive_char(rx_ring_buffer *buffer, volatile uint8_t *ucsra,
+  volatile uint8_t *ucsrb, volatile uint8_t *udr)
+{
+  unsigned char status = *ucsra;
+#if SERIAL_MULTIPROCESSOR
+  unsigned char control = *ucsrb;
+#endif
+  unsigned char c = *udr;
+
+#if SERIAL_MULTIPROCESSOR
+  if (buffer->mpcm && (control & _BV(RXB80))) {
+    // an address frame: listen to the data that follows only if it's for
+    // us, otherwise let the hardware skip it
+    set_mpcm(ucsra, c != buffer->mpcm_address);
+    return;
+  }
+#endif
+
+  if (status & (_BV(UPE0) | _BV(FE0) | _BV(DOR0))) {
+    if (status & _BV(DOR0))
+      count_error(&buffer->overruns);
+    if (status & _BV(FE0))
+      count_error(&buffer->frame_errors);
+    if (status & _BV(UPE0)) {
+      count_error(&buffer->parity_errors);
+      return;
+    }
+  }
+  store_char(c, buffer);
+}
+
 #if !defined(USART0_RX_vect) && defined(USART1_RX_vect)
 // do nothing - on the 32u4 the first USART is USART1
 #else
@@ -120,19 +378,9 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
 #endif
   {
   #if defined(UDR0)
-    if (bit_is_clear(UCSR0A, UPE0)) {
-      unsigned char c = UDR0;
-      store_char(c, &rx_buffer);
-    } else {
-      unsigned char c = UDR0;
-    };
+    receive_char(&rx_buffer, &UCSR0A, &UCSR0B, &UDR0);
   #elif defined(UDR)
-    if (bit_is_clear(UCSRA, PE)) {
-      unsigned char c = UDR;
-      store_char(c, &rx_buffer);
-    } else {
-      unsigned char c = UDR;
-    };
+    receive_char(&rx_buffer, &UCSRA, &UCSRB, &UDR);
   #else
     #error UDR not defined
   #endif
@@ -146,12 +394,7 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
   #define serialEvent1_implemented
   ISR(USART1_RX_vect)
   {
-    if (bit_is_clear(UCSR1A, UPE1)) {
-      unsigned char c = UDR1;
-      store_char(c, &rx_buffer1);
-    } else {
-      unsigned char c = UDR1;
-    };
+    receive_char(&rx_buffer1, &UCSR1A, &UCSR1B, &UDR1);
   }
 #endif
 
@@ -161,12 +404,7 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
   #define serialEvent2_implemented
   ISR(USART2_RX_vect)
   {
-    if (bit_is_clear(UCSR2A, UPE2)) {
-      unsigned char c = UDR2;
-      store_char(c, &rx_buffer2);
-    } else {
-      unsigned char c = UDR2;
-    };
+    receive_char(&rx_buffer2, &UCSR2A, &UCSR2B, &UDR2);
   }
 #endif
 
@@ -176,17 +414,28 @@ inline void store_char(unsigned char c, ring_buffer *buffer)
   #define serialEvent3_implemented
   ISR(USART3_RX_vect)
   {
-    if (bit_is_clear(UCSR3A, UPE3)) {
-      unsigned char c = UDR3;
-      store_char(c, &rx_buffer3);
-    } else {
-      unsigned char c = UDR3;
-    };
+    receive_char(&rx_buffer3, &UCSR3A, &UCSR3B, &UDR3);
   }
 #endif
 
 void serialEventRun(void)
 {
+#if SERIAL_FLOW_CONTROL
+  // restart transmissions paused by CTS
+#if defined(UBRRH) || defined(UBRR0H)
+  Serial.pollFlowControl();
+#endif
+#if defined(UBRR1H)
+  Serial1.pollFlowControl();
+#endif
+#if defined(UBRR2H)
+  Serial2.pollFlowControl();
+#endif
+#if defined(UBRR3H)
+  Serial3.pollFlowControl();
+#endif
+#endif
+
 #ifdef serialEvent_implemented
   if (Serial.available()) serialEvent();
 #endif
@@ -218,8 +467,8 @@ ISR(USART0_UDRE_vect)
 ISR(USART_UDRE_vect)
 #endif
 {
-  if (tx_buffer.head == tx_buffer.tail) {
-	// Buffer empty, so disable interrupts
+  if (tx_buffer.head == tx_buffer.tail || tx_paused(&tx_buffer)) {
+	// Buffer empty (or CTS deasserted), so disable interrupts
 #if defined(UCSR0B)
     cbi(UCSR0B, UDRIE0);
 #else
@@ -229,7 +478,7 @@ ISR(USART_UDRE_vect)
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer.buffer[tx_buffer.tail];
-    tx_buffer.tail = (tx_buffer.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer.tail = (ring_index_t)(tx_buffer.tail + 1) & tx_buffer.mask;
 	
   #if defined(UDR0)
     UDR0 = c;
@@ -246,14 +495,14 @@ ISR(USART_UDRE_vect)
 #ifdef USART1_UDRE_vect
 ISR(USART1_UDRE_vect)
 {
-  if (tx_buffer1.head == tx_buffer1.tail) {
-	// Buffer empty, so disable interrupts
+  if (tx_buffer1.head == tx_buffer1.tail || tx_paused(&tx_buffer1)) {
+	// Buffer empty (or CTS deasserted), so disable interrupts
     cbi(UCSR1B, UDRIE1);
   }
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer1.buffer[tx_buffer1.tail];
-    tx_buffer1.tail = (tx_buffer1.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer1.tail = (ring_index_t)(tx_buffer1.tail + 1) & tx_buffer1.mask;
 	
     UDR1 = c;
   }
@@ -263,14 +512,14 @@ ISR(USART1_UDRE_vect)
 #ifdef USART2_UDRE_vect
 ISR(USART2_UDRE_vect)
 {
-  if (tx_buffer2.head == tx_buffer2.tail) {
-	// Buffer empty, so disable interrupts
+  if (tx_buffer2.head == tx_buffer2.tail || tx_paused(&tx_buffer2)) {
+	// Buffer empty (or CTS deasserted), so disable interrupts
     cbi(UCSR2B, UDRIE2);
   }
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer2.buffer[tx_buffer2.tail];
-    tx_buffer2.tail = (tx_buffer2.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer2.tail = (ring_index_t)(tx_buffer2.tail + 1) & tx_buffer2.mask;
 	
     UDR2 = c;
   }
@@ -280,14 +529,14 @@ ISR(USART2_UDRE_vect)
 #ifdef USART3_UDRE_vect
 ISR(USART3_UDRE_vect)
 {
-  if (tx_buffer3.head == tx_buffer3.tail) {
-	// Buffer empty, so disable interrupts
+  if (tx_buffer3.head == tx_buffer3.tail || tx_paused(&tx_buffer3)) {
+	// Buffer empty (or CTS deasserted), so disable interrupts
     cbi(UCSR3B, UDRIE3);
   }
   else {
     // There is more data in the output buffer. Send the next byte
     unsigned char c = tx_buffer3.buffer[tx_buffer3.tail];
-    tx_buffer3.tail = (tx_buffer3.tail + 1) % SERIAL_BUFFER_SIZE;
+    tx_buffer3.tail = (ring_index_t)(tx_buffer3.tail + 1) & tx_buffer3.mask;
 	
     UDR3 = c;
   }
@@ -297,7 +546,7 @@ ISR(USART3_UDRE_vect)
 
 // Constructors ////////////////////////////////////////////////////////////////
 
-HardwareSerial::HardwareSerial(ring_buffer *rx_buffer, ring_buffer *tx_buffer,
+HardwareSerial::HardwareSerial(rx_ring_buffer *rx_buffer, tx_ring_buffer *tx_buffer,
   volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
   volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
   volatile uint8_t *ucsrc, volatile uint8_t *udr,
@@ -412,8 +661,8 @@ try_again:
 void HardwareSerial::end()
 {
   // wait for transmission of outgoing data
-  while (_tx_buffer->head != _tx_buffer->tail)
-    ;
+  while (_tx_buffer->head != atomic_index(&_tx_buffer->tail))
+    pollFlowControl();
 
   cbi(*_ucsrb, _rxen);
   cbi(*_ucsrb, _txen);
@@ -426,12 +675,12 @@ void HardwareSerial::end()
 
 int HardwareSerial::available(void)
 {
-  return (unsigned int)(SERIAL_BUFFER_SIZE + _rx_buffer->head - _rx_buffer->tail) % SERIAL_BUFFER_SIZE;
+  return (ring_index_t)(atomic_index(&_rx_buffer->head) - _rx_buffer->tail) & _rx_buffer->mask;
 }
 
 int HardwareSerial::peek(void)
 {
-  if (_rx_buffer->head == _rx_buffer->tail) {
+  if (atomic_index(&_rx_buffer->head) == _rx_buffer->tail) {
     return -1;
   } else {
     return _rx_buffer->buffer[_rx_buffer->tail];
@@ -441,31 +690,235 @@ int HardwareSerial::peek(void)
 int HardwareSerial::read(void)
 {
   // if the head isn't ahead of the tail, we don't have any characters
-  if (_rx_buffer->head == _rx_buffer->tail) {
+  if (atomic_index(&_rx_buffer->head) == _rx_buffer->tail) {
     return -1;
   } else {
     unsigned char c = _rx_buffer->buffer[_rx_buffer->tail];
-    _rx_buffer->tail = (unsigned int)(_rx_buffer->tail + 1) % SERIAL_BUFFER_SIZE;
+    _rx_buffer->tail = (ring_index_t)(_rx_buffer->tail + 1) & _rx_buffer->mask;
+    updateRts();
     return c;
   }
 }
 
+int HardwareSerial::read(uint8_t *buffer, size_t length)
+{
+  size_t count = 0;
+
+  // copy the contiguous runs straight out of the ring buffer
+  while (count < length) {
+    const uint8_t *data;
+    size_t n = peekBuffer(&data);
+    if (n == 0) break;
+    if (n > length - count) n = length - count;
+    memcpy(buffer + count, data, n);
+    consume(n);
+    count += n;
+  }
+  return count;
+}
+
+size_t HardwareSerial::peekBuffer(const uint8_t **data)
+{
+  ring_index_t head = atomic_index(&_rx_buffer->head);
+  ring_index_t tail = _rx_buffer->tail;
+
+  *data = _rx_buffer->buffer + tail;
+
+  // if the data wraps around the end of the buffer, only the part up to
+  // the end is contiguous; the rest is returned by the next call
+  if (head >= tail)
+    return head - tail;
+  return (unsigned int)_rx_buffer->mask + 1 - tail;
+}
+
+void HardwareSerial::consume(size_t n)
+{
+  size_t count = available();
+  if (n > count) n = count;
+
+  // the interrupt handler never writes at or beyond the tail, so the data
+  // handed out by peekBuffer() stays valid until it's consumed here
+  _rx_buffer->tail = (ring_index_t)(_rx_buffer->tail + n) & _rx_buffer->mask;
+  updateRts();
+}
+
+SerialStats HardwareSerial::stats()
+{
+  SerialStats stats;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  stats.dropped = _rx_buffer->dropped;
+  stats.overruns = _rx_buffer->overruns;
+  stats.parityErrors = _rx_buffer->parity_errors;
+  stats.frameErrors = _rx_buffer->frame_errors;
+  stats.maxAvailable = _rx_buffer->peak;
+  SREG = oldSREG;
+
+  return stats;
+}
+
+void HardwareSerial::resetStats()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  _rx_buffer->dropped = 0;
+  _rx_buffer->overruns = 0;
+  _rx_buffer->parity_errors = 0;
+  _rx_buffer->frame_errors = 0;
+  _rx_buffer->peak = 0;
+  SREG = oldSREG;
+}
+
 void HardwareSerial::flush()
 {
   // UDR is kept full while the buffer is not empty, so TXC triggers when EMPTY && SENT
-  while (transmitting && ! (*_ucsra & _BV(TXC0)));
+  // (unless CTS paused the transmission, hence the check for an empty buffer)
+  while (transmitting && (_tx_buffer->head != atomic_index(&_tx_buffer->tail) || ! (*_ucsra & _BV(TXC0))))
+    pollFlowControl();
   transmitting = false;
 }
 
+#if SERIAL_MULTIPROCESSOR
+void HardwareSerial::setAddress(uint8_t address)
+{
+  flush();
+
+  uint8_t oldSREG = SREG;
+  cli();
+  _rx_buffer->mpcm_address = address;
+  _rx_buffer->mpcm = true;
+  sbi(*_ucsrb, UCSZ02);
+  set_mpcm(_ucsra, true);
+  SREG = oldSREG;
+}
+
+void HardwareSerial::clearAddress()
+{
+  flush();
+
+  uint8_t oldSREG = SREG;
+  cli();
+  _rx_buffer->mpcm = false;
+  cbi(*_ucsrb, UCSZ02);
+  set_mpcm(_ucsra, false);
+  SREG = oldSREG;
+}
+
+size_t HardwareSerial::writeAddress(uint8_t address)
+{
+  // the 9th bit goes along with whatever is in the data register, so wait
+  // for everything queued before to be on its way
+  flush();
+  sbi(*_ucsrb, UCSZ02);
+
+  uint8_t oldSREG = SREG;
+  cli();
+  sbi(*_ucsrb, TXB80);
+  *_udr = address;
+  transmitting = true;
+  sbi(*_ucsra, TXC0);
+  SREG = oldSREG;
+
+  // keep the 9th bit set until the address has moved to the shift register
+  while (!(*_ucsra & _BV(UDRE0)))
+    ;
+  cbi(*_ucsrb, TXB80);
+
+  return 1;
+}
+#endif
+
+#if SERIAL_FLOW_CONTROL
+void HardwareSerial::setRts(uint8_t pin, unsigned int highWater, unsigned int lowWater)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PIN) return;
+
+  // by default stop the other side at 3/4 of the buffer, leaving room for
+  // the bytes it sends before noticing, and let it go again at 1/4
+  unsigned int size = (unsigned int)_rx_buffer->mask + 1;
+  if (highWater == 0 || highWater > size - 1) highWater = size - size / 4;
+  if (lowWater == 0) lowWater = size / 4;
+  if (lowWater >= highWater) lowWater = highWater - 1;
+  _rts_low = lowWater;
+
+  pinMode(pin, OUTPUT);
+
+  uint8_t oldSREG = SREG;
+  cli();
+  _rx_buffer->rts_mask = digitalPinToBitMask(pin);
+  _rx_buffer->rts_threshold = highWater;
+  _rx_buffer->rts_reg = portOutputRegister(port);
+  SREG = oldSREG;
+
+  digitalWrite(pin, (unsigned int)available() >= highWater ? HIGH : LOW);
+}
+
+void HardwareSerial::setCts(uint8_t pin)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PIN) return;
+
+  pinMode(pin, INPUT);
+
+  uint8_t oldSREG = SREG;
+  cli();
+  _tx_buffer->cts_mask = digitalPinToBitMask(pin);
+  _tx_buffer->cts_reg = portInputRegister(port);
+  SREG = oldSREG;
+}
+
+void HardwareSerial::noFlowControl()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  _rx_buffer->rts_reg = 0;
+  _tx_buffer->cts_reg = 0;
+  SREG = oldSREG;
+
+  // resume anything that was waiting for CTS
+  if (_tx_buffer->head != atomic_index(&_tx_buffer->tail))
+    sbi(*_ucsrb, _udrie);
+}
+
+#endif
+
+void HardwareSerial::pollFlowControl()
+{
+#if SERIAL_FLOW_CONTROL
+  if (_tx_buffer->cts_reg && !tx_paused(_tx_buffer) &&
+      _tx_buffer->head != atomic_index(&_tx_buffer->tail))
+    sbi(*_ucsrb, _udrie);
+#endif
+}
+
+// reasserts RTS once read() or consume() bring the buffer down to the low
+// watermark
+void HardwareSerial::updateRts()
+{
+#if SERIAL_FLOW_CONTROL
+  volatile uint8_t *reg = _rx_buffer->rts_reg;
+  if (reg == 0 || !(*reg & _rx_buffer->rts_mask))
+    return;
+
+  uint8_t oldSREG = SREG;
+  cli();
+  if ((unsigned int)((ring_index_t)(_rx_buffer->head - _rx_buffer->tail) & _rx_buffer->mask) <= _rts_low)
+    *reg &= ~_rx_buffer->rts_mask;
+  SREG = oldSREG;
+#endif
+}
+
 size_t HardwareSerial::write(uint8_t c)
 {
-  int i = (_tx_buffer->head + 1) % SERIAL_BUFFER_SIZE;
+  ring_index_t i = (ring_index_t)(_tx_buffer->head + 1) & _tx_buffer->mask;
 	
   // If the output buffer is full, there's nothing for it other than to 
   // wait for the interrupt handler to empty it a bit
   // ???: return 0 here instead?
-  while (i == _tx_buffer->tail)
-    ;
+  while (i == atomic_index(&_tx_buffer->tail))
+    pollFlowControl();
 	
   _tx_buffer->buffer[_tx_buffer->head] = c;
   _tx_buffer->head = i;
@@ -478,6 +931,48 @@ size_t HardwareSerial::write(uint8_t c)
   return 1;
 }
 
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = size;
+
+  while (n > 0) {
+    ring_index_t head = _tx_buffer->head;
+    // one slot is always left empty so that a full buffer can be told
+    // apart from an empty one
+    unsigned int room = (ring_index_t)(atomic_index(&_tx_buffer->tail) - head - 1) & _tx_buffer->mask;
+
+    // If the output buffer is full, wait for the interrupt handler to
+    // empty it a bit (it is already enabled, since the buffer isn't empty,
+    // unless CTS paused it)
+    if (room == 0) {
+      pollFlowControl();
+      continue;
+    }
+
+    // copy as much as fits before the end of the buffer in one go, so
+    // the head index (which the interrupt handler reads) moves only once
+    // per contiguous span instead of once per byte
+    unsigned int span = (unsigned int)_tx_buffer->mask + 1 - head;
+    if (span > room) span = room;
+    if (span > n) span = n;
+
+    memcpy(_tx_buffer->buffer + head, buffer, span);
+    _tx_buffer->head = (ring_index_t)(head + span) & _tx_buffer->mask;
+    buffer += span;
+    n -= span;
+
+    sbi(*_ucsrb, _udrie);
+  }
+
+  if (size > 0) {
+    // clear the TXC bit -- "can be cleared by writing a one to its bit location"
+    transmitting = true;
+    sbi(*_ucsra, TXC0);
+  }
+
+  return size;
+}
+
 HardwareSerial::operator bool() {
 	return true;
 }
@@ -27,13 +27,38 @@
 
 #include "Stream.h"
 
-struct ring_buffer;
+// Hardware flow control (setRts(), setCts()) and the 9-bit multiprocessor
+// mode (setAddress()) add to the receive interrupt handler and to each
+// buffer, so they're only built in when enabled with
+// -DSERIAL_FLOW_CONTROL=1 or -DSERIAL_MULTIPROCESSOR=1.  These must be
+// given on the compiler command line (e.g. build.extra_flags in
+// boards.txt), since this header and HardwareSerial.cpp have to agree.
+#ifndef SERIAL_FLOW_CONTROL
+#define SERIAL_FLOW_CONTROL 0
+#endif
+#ifndef SERIAL_MULTIPROCESSOR
+#define SERIAL_MULTIPROCESSOR 0
+#endif
+
+struct rx_ring_buffer;
+struct tx_ring_buffer;
+
+// receive statistics, see HardwareSerial::stats().  counters saturate
+// instead of wrapping around.
+struct SerialStats
+{
+  uint16_t dropped;       // bytes lost because the receive buffer was full
+  uint16_t overruns;      // data overruns flagged by the hardware (bytes lost before the interrupt ran)
+  uint16_t parityErrors;  // bytes discarded because of a parity error
+  uint16_t frameErrors;   // bytes received with a framing error (bad stop bit)
+  uint16_t maxAvailable;  // highest number of bytes seen waiting in the receive buffer
+};
 
 class HardwareSerial : public Stream
 {
   private:
-    ring_buffer *_rx_buffer;
-    ring_buffer *_tx_buffer;
+    rx_ring_buffer *_rx_buffer;
+    tx_ring_buffer *_tx_buffer;
     volatile uint8_t *_ubrrh;
     volatile uint8_t *_ubrrl;
     volatile uint8_t *_ucsra;
@@ -46,8 +71,12 @@ class HardwareSerial : public Stream
     uint8_t _udrie;
     uint8_t _u2x;
     bool transmitting;
+#if SERIAL_FLOW_CONTROL
+    unsigned int _rts_low;
+#endif
+    void updateRts();
   public:
-    HardwareSerial(ring_buffer *rx_buffer, ring_buffer *tx_buffer,
+    HardwareSerial(rx_ring_buffer *rx_buffer, tx_ring_buffer *tx_buffer,
       volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
       volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
       volatile uint8_t *ucsrc, volatile uint8_t *udr,
@@ -58,13 +87,43 @@ class HardwareSerial : public Stream
     virtual int available(void);
     virtual int peek(void);
     virtual int read(void);
+    virtual int read(uint8_t *buffer, size_t length);
+    // direct access to received data: points *data at the oldest unread
+    // byte and returns how many bytes follow it contiguously in the buffer
+    // (0 if none); consume(n) then discards n of them
+    size_t peekBuffer(const uint8_t **data);
+    void consume(size_t n);
+    SerialStats stats();
+    void resetStats();
+#if SERIAL_FLOW_CONTROL
+    // hardware flow control.  the RTS pin is driven high when highWater
+    // bytes are waiting in the receive buffer and low again once reading
+    // brings them down to lowWater (0 picks 3/4 and 1/4 of the buffer).
+    // nothing is sent while the CTS pin is high.
+    void setRts(uint8_t pin, unsigned int highWater = 0, unsigned int lowWater = 0);
+    void setCts(uint8_t pin);
+    void noFlowControl();
+#endif
+    // resumes sending when CTS is asserted again; called after each loop()
+    // (does nothing without SERIAL_FLOW_CONTROL)
+    void pollFlowControl();
+#if SERIAL_MULTIPROCESSOR
+    // 9-bit multiprocessor communication mode for multidrop (e.g. RS-485)
+    // buses.  frames with the 9th bit set carry a node address; after
+    // setAddress() the hardware ignores data frames until an address frame
+    // matching this node is received.  writeAddress() selects a node.
+    void setAddress(uint8_t address);
+    void clearAddress();
+    size_t writeAddress(uint8_t address);
+#endif
     virtual void flush(void);
     virtual size_t write(uint8_t);
+    virtual size_t write(const uint8_t *buffer, size_t size);
     inline size_t write(unsigned long n) { return write((uint8_t)n); }
     inline size_t write(long n) { return write((uint8_t)n); }
     inline size_t write(unsigned int n) { return write((uint8_t)n); }
     inline size_t write(int n) { return write((uint8_t)n); }
-    using Print::write; // pull in write(str) and write(buf, size) from Print
+    using Print::write; // pull in write(str) from Print
     operator bool();
 };
 
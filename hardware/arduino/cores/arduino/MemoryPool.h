@@ -0,0 +1,98 @@
+/*
+  MemoryPool.h - fixed-size block pool and arena allocators
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef MemoryPool_h
+#define MemoryPool_h
+
+#include <stddef.h>
+#include <inttypes.h>
+#include "new.h"
+
+// malloc() and new share one heap, and after many allocations and frees
+// of different sizes it can end up too fragmented to satisfy a request
+// even though enough memory is free in total.  These allocators manage a
+// buffer of their own instead, so they can't fragment the heap (or be
+// fragmented by it).  Neither may be used from an interrupt handler.
+
+// Hands out blocks of one fixed size from the given memory.  Any free
+// block fits any request, so the pool never fragments.
+//
+//   uint8_t poolMemory[8 * 32];
+//   BlockPool pool(poolMemory, sizeof(poolMemory), 32);
+//   Message *m = new (pool) Message();
+//   ...
+//   poolDelete(pool, m);
+class BlockPool
+{
+  private:
+    uint8_t *_begin;
+    uint8_t *_end;
+    void *_free;          // first free block; each free block points to the next
+    size_t _blockSize;
+    size_t _available;
+  public:
+    BlockPool(void *memory, size_t size, size_t blockSize);
+    void *allocate(void);         // returns a block, or NULL if none are free
+    void release(void *block);    // returns a block to the pool (NULL is ignored)
+    bool owns(const void *block) const { return block >= _begin && block < _end; }
+    size_t blockSize(void) const { return _blockSize; }
+    size_t available(void) const { return _available; }  // number of free blocks
+};
+
+// Hands out memory of any size from the given buffer, one piece after the
+// other, and gives it all back at once with reset().  Suited to data that's
+// needed only while handling one request or one pass of loop().
+class Arena
+{
+  private:
+    uint8_t *_begin;
+    size_t _size;
+    size_t _used;
+  public:
+    Arena(void *memory, size_t size) : _begin((uint8_t *)memory), _size(size), _used(0) {}
+    void *allocate(size_t size);  // returns NULL if there isn't enough room left
+    void reset(void) { _used = 0; }  // frees everything; no destructors are called
+    size_t used(void) const { return _used; }
+    size_t available(void) const { return _size - _used; }
+};
+
+// new (pool) T(...) / new (arena) T(...); the result is NULL if the pool
+// is empty (or the block is too small) or the arena is full.  throw() is
+// what tells the compiler that these can return NULL: without it, it
+// leaves out the check and runs the constructor at address 0.
+inline void * operator new(size_t size, BlockPool &pool) throw()
+{
+  return size <= pool.blockSize() ? pool.allocate() : NULL;
+}
+
+inline void * operator new(size_t size, Arena &arena) throw()
+{
+  return arena.allocate(size);
+}
+
+// destroys an object created with new (pool) and returns its block
+template <class T> void poolDelete(BlockPool &pool, T *object)
+{
+  if (object) {
+    object->~T();
+    pool.release(object);
+  }
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+  PinGroup.cpp - write and read several digital pins at once
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include "Arduino.h"
+#include "PinGroup.h"
+
+PinGroup::PinGroup(const uint8_t *pins, uint8_t count)
+{
+  if (count > PINGROUP_MAX_PINS) count = PINGROUP_MAX_PINS;
+  _count = count;
+  _ports = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t port = pins[i] < NUM_DIGITAL_PINS ? digitalPinToPort(pins[i]) : NOT_A_PORT;
+    if (port == NOT_A_PORT) {
+      // a bit that's never written and always reads as 0
+      _pinPort[i] = 0;
+      _pinMask[i] = 0;
+      continue;
+    }
+
+    uint8_t p = 0;
+    while (p < _ports && _port[p] != port) p++;
+    if (p == _ports) {
+      _port[p] = port;
+      _portMask[p] = 0;
+      _out[p] = portOutputRegister(port);
+      _in[p] = portInputRegister(port);
+      _ports++;
+    }
+    _pinPort[i] = p;
+    _pinMask[i] = digitalPinToBitMask(pins[i]);
+    _portMask[p] |= _pinMask[i];
+  }
+}
+
+void PinGroup::mode(uint8_t mode)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  for (uint8_t p = 0; p < _ports; p++) {
+    volatile uint8_t *reg = portModeRegister(_port[p]);
+    // in the same order as pinMode(), so an input never drives the pin
+    if (mode == OUTPUT) {
+      *reg |= _portMask[p];
+    } else {
+      *reg &= ~_portMask[p];
+      if (mode == INPUT_PULLUP) *_out[p] |= _portMask[p];
+      else *_out[p] &= ~_portMask[p];
+    }
+  }
+  SREG = oldSREG;
+}
+
+void PinGroup::write(unsigned int value)
+{
+  // work out the new bits of each port first, so that the ports are
+  // written one straight after the other
+  uint8_t bits[PINGROUP_MAX_PINS];
+  memset(bits, 0, _ports);
+  for (uint8_t i = 0; i < _count; i++, value >>= 1) {
+    if (value & 1) bits[_pinPort[i]] |= _pinMask[i];
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  for (uint8_t p = 0; p < _ports; p++) {
+    *_out[p] = (*_out[p] & ~_portMask[p]) | bits[p];
+  }
+  SREG = oldSREG;
+}
+
+unsigned int PinGroup::read(void)
+{
+  uint8_t bits[PINGROUP_MAX_PINS];
+  uint8_t oldSREG = SREG;
+  cli();
+  for (uint8_t p = 0; p < _ports; p++) {
+    bits[p] = *_in[p];
+  }
+  SREG = oldSREG;
+
+  unsigned int value = 0;
+  for (uint8_t i = _count; i > 0; i--) {
+    value <<= 1;
+    if (bits[_pinPort[i - 1]] & _pinMask[i - 1]) value |= 1;
+  }
+  return value;
+}
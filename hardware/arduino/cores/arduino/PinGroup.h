@@ -0,0 +1,64 @@
+/*
+  PinGroup.h - write and read several digital pins at once
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef PinGroup_h
+#define PinGroup_h
+
+#include <inttypes.h>
+
+// the most pins in a group (at most 16)
+#ifndef PINGROUP_MAX_PINS
+#define PINGROUP_MAX_PINS 8
+#endif
+
+// A set of pins that are written or read together as the bits of a number,
+// e.g. the data lines of a parallel bus.  The ports and bits of the pins
+// are looked up once, when the group is created; write() then changes
+// each port the pins are on with a single read-modify-write, all with
+// interrupts disabled, so the pins change together instead of one after
+// the other.  Likewise read() samples all the pins at the same moment.
+//
+// Like digitalWriteFast(), write() doesn't turn off PWM on the pins.
+//
+//   const uint8_t dataPins[] = { 2, 3, 4, 5, 6, 7, 8, 9 };
+//   PinGroup data(dataPins, 8);
+//   data.mode(OUTPUT);
+//   data.write(0x5a);   // pin 2 is bit 0, pin 9 is bit 7
+class PinGroup
+{
+  private:
+    uint8_t _count;                             // number of pins
+    uint8_t _ports;                             // number of different ports among them
+    uint8_t _pinPort[PINGROUP_MAX_PINS];        // index of each pin's port below
+    uint8_t _pinMask[PINGROUP_MAX_PINS];        // bit of each pin in its port
+    uint8_t _port[PINGROUP_MAX_PINS];           // the ports, as for portOutputRegister()
+    uint8_t _portMask[PINGROUP_MAX_PINS];       // the bits of the group's pins in each port
+    volatile uint8_t *_out[PINGROUP_MAX_PINS];  // each port's output and input register
+    volatile uint8_t *_in[PINGROUP_MAX_PINS];
+  public:
+    // pins[0] is bit 0 of the values written and read; pins past
+    // PINGROUP_MAX_PINS and pin numbers that don't exist are ignored
+    PinGroup(const uint8_t *pins, uint8_t count);
+    void mode(uint8_t mode);      // as pinMode() on each pin
+    void write(unsigned int value);
+    unsigned int read(void);
+    uint8_t count(void) const { return _count; }
+};
+
+#endif
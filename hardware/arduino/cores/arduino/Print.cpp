@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <float.h>
 #include "Arduino.h"
 
 #include "Print.h"
@@ -43,19 +44,46 @@ size_t Print::print(const __FlashStringHelper *ifsh)
 {
   const char PROGMEM *p = (const char PROGMEM *)ifsh;
   size_t n = 0;
+  // copy the string to RAM a chunk at a time, so that it goes out in a
+  // few bulk writes rather than one write per character
+  uint8_t buffer[32];
   while (1) {
-    unsigned char c = pgm_read_byte(p++);
-    if (c == 0) break;
-    n += write(c);
+    uint8_t len = 0;
+    while (len < sizeof(buffer)) {
+      unsigned char c = pgm_read_byte(p++);
+      if (c == 0) break;
+      buffer[len++] = c;
+    }
+    if (len > 0) n += write(buffer, len);
+    if (len < sizeof(buffer)) break;
   }
   return n;
 }
 
 size_t Print::print(const String &s)
 {
+  // some clients flag an error on a zero-length write
+  if (s.length() == 0) return 0;
+  return write((const uint8_t *)s.c_str(), s.length());
+}
+
+size_t Print::print(const StringView &s)
+{
+  if (s.length() == 0) return 0;
+  if (!s.isFlash())
+    return write((const uint8_t *)s.data(), s.length());
+
+  // as print(F()), copy flash a chunk at a time
+  const char *p = s.data();
+  size_t remaining = s.length();
   size_t n = 0;
-  for (uint16_t i = 0; i < s.length(); i++) {
-    n += write(s[i]);
+  uint8_t buffer[32];
+  while (remaining > 0) {
+    size_t len = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+    memcpy_P(buffer, p, len);
+    n += write(buffer, len);
+    p += len;
+    remaining -= len;
   }
   return n;
 }
@@ -91,9 +119,7 @@ size_t Print::print(long n, int base)
     return write(n);
   } else if (base == 10) {
     if (n < 0) {
-      int t = print('-');
-      n = -n;
-      return printNumber(n, 10) + t;
+      return printNumber(0UL - (unsigned long)n, 10, true);
     }
     return printNumber(n, 10);
   } else {
@@ -138,6 +164,13 @@ size_t Print::println(const String &s)
   return n;
 }
 
+size_t Print::println(const StringView &s)
+{
+  size_t n = print(s);
+  n += println();
+  return n;
+}
+
 size_t Print::println(const char c[])
 {
   size_t n = print(c);
@@ -203,66 +236,177 @@ size_t Print::println(const Printable& x)
 
 // Private Methods /////////////////////////////////////////////////////////////
 
-size_t Print::printNumber(unsigned long n, uint8_t base) {
-  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+// Writes the decimal digits of n backwards, ending just before str, and
+// returns a pointer to the first one.  Divides by 10 with shifts and adds:
+// the AVR has no divide instruction and the library routine for a 32-bit
+// division takes several hundred cycles per digit.
+static char *decimalDigits(unsigned long n, char *str)
+{
+  while (n > 0xFFFF) {
+    unsigned long q = (n >> 1) + (n >> 2);
+    q += q >> 4;
+    q += q >> 8;
+    q += q >> 16;
+    q >>= 3;
+    uint8_t r = n - (((q << 2) + q) << 1);
+    if (r > 9) {
+      q++;
+      r -= 10;
+    }
+    *--str = r + '0';
+    n = q;
+  }
+  // the rest fits in 16 bits, which makes each step a lot cheaper
+  uint16_t m = n;
+  do {
+    uint16_t q = (m >> 1) + (m >> 2);
+    q += q >> 4;
+    q += q >> 8;
+    q >>= 3;
+    uint8_t r = m - (((q << 2) + q) << 1);
+    if (r > 9) {
+      q++;
+      r -= 10;
+    }
+    *--str = r + '0';
+    m = q;
+  } while (m);
+  return str;
+}
 
-  *str = '\0';
+size_t Print::printNumber(unsigned long n, uint8_t base, bool negative) {
+  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus sign.
+  char *end = &buf[sizeof(buf)];
+  char *str = end;
 
   // prevent crash if called with base == 1
   if (base < 2) base = 10;
 
-  do {
-    unsigned long m = n;
-    n /= base;
-    char c = m - base * n;
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+  if (base == 10) {
+    str = decimalDigits(n, str);
+  } else if ((base & (base - 1)) == 0) {
+    // powers of two (HEX, OCT, BIN): each digit is a group of bits
+    uint8_t shift = 1;
+    while ((1 << shift) != base) shift++;
+    uint8_t mask = base - 1;
+
+    do {
+      char c = (uint8_t)n & mask;
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+      n >>= shift;
+    } while (n);
+  } else {
+    do {
+      unsigned long m = n;
+      n /= base;
+      char c = m - base * n;
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while(n);
+  }
 
-  return write(str);
+  if (negative) *--str = '-';
+
+  return write((const uint8_t *)str, end - str);
 }
 
+// 0.5 / 10^digits, computed with the same sequence of divisions as the
+// loop in printFloat() so the results are identical
+#define ROUNDING_DIVISIONS 8
+static const double rounding_PGM[ROUNDING_DIVISIONS + 1] PROGMEM = {
+  0.5,
+  0.5 / 10.0,
+  0.5 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0,
+  0.5 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0 / 10.0,
+};
+
 size_t Print::printFloat(double number, uint8_t digits) 
 { 
   size_t n = 0;
+  char buf[24];
+  char *end = &buf[sizeof(buf)];
+  char *str;
   
   if (isnan(number)) return print("nan");
   if (isinf(number)) return print("inf");
   if (number > 4294967040.0) return print ("ovf");  // constant determined empirically
   if (number <-4294967040.0) return print ("ovf");  // constant determined empirically
   
-  // Handle negative numbers
-  if (number < 0.0)
-  {
-     n += print('-');
-     number = -number;
-  }
-
   // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i=0; i<digits; ++i)
+  double rounding;
+  uint8_t i = digits < ROUNDING_DIVISIONS ? digits : ROUNDING_DIVISIONS;
+  memcpy_P(&rounding, &rounding_PGM[i], sizeof(rounding));
+  for (; i<digits; ++i)
     rounding /= 10.0;
-  
+
+  bool negative = number < 0.0;
+  if (negative) number = -number;
   number += rounding;
 
-  // Extract the integer part of the number and print it
+  // Extract the integer part of the number; it goes into the buffer along
+  // with the sign and as many digits as fit, all written at once
   unsigned long int_part = (unsigned long)number;
   double remainder = number - (double)int_part;
-  n += print(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) {
-    n += print("."); 
+  str = decimalDigits(int_part, end - 12);
+  if (negative) *--str = '-';
+  char *p = end - 12;
+  if (digits > 0) *p++ = '.';
+
+  // The digits used to be extracted by repeatedly multiplying the
+  // remainder by 10.0 and taking the integer part.  Doing that in soft
+  // float for every digit is slow, so the remainder is split once into
+  // an integer mantissa m and a number of fraction bits e
+  // (remainder == m / 2^e) and the multiplications are done on m,
+  // rounding the product to the precision of a double exactly like the
+  // floating point code did.  This gives the same digits.
+  const uint8_t bits = 8 * sizeof(unsigned long);
+  const unsigned long limit = 1UL << DBL_MANT_DIG; // DBL_MANT_DIG + 4 must fit in bits
+  unsigned long m = 0;
+  int e = 0;
+  if (remainder > 0.0) {
+    int exp;
+    m = (unsigned long)ldexp(frexp(remainder, &exp), DBL_MANT_DIG);
+    e = DBL_MANT_DIG - exp;
   }
 
-  // Extract digits from the remainder one at a time
   while (digits-- > 0)
   {
-    remainder *= 10.0;
-    int toPrint = int(remainder);
-    n += print(toPrint);
-    remainder -= toPrint; 
-  } 
-  
+    unsigned long t = m * 10;
+
+    // round to DBL_MANT_DIG significant bits, ties to even
+    uint8_t s = 0;
+    while ((t >> s) >= limit) s++;
+    if (s > 0) {
+      unsigned long half = 1UL << (s - 1);
+      unsigned long low = t & ((half << 1) - 1);
+      t >>= s;
+      if (low > half || (low == half && (t & 1))) t++;
+      e -= s;
+    }
+
+    uint8_t digit = 0;
+    if (e < bits) {
+      digit = t >> e;
+      t &= (1UL << e) - 1;
+    }
+    m = t;
+
+    if (digit >= 10) {
+      *p++ = '1';
+      digit -= 10;
+    }
+    *p++ = digit + '0';
+
+    if (p > end - 2) {
+      n += write((const uint8_t *)str, p - str);
+      str = p = end - 12;
+    }
+  }
+
+  n += write((const uint8_t *)str, p - str);
   return n;
 }
@@ -35,7 +35,7 @@ class Print
 {
   private:
     int write_error;
-    size_t printNumber(unsigned long, uint8_t);
+    size_t printNumber(unsigned long, uint8_t, bool = false);
     size_t printFloat(double, uint8_t);
   protected:
     void setWriteError(int err = 1) { write_error = err; }
@@ -54,6 +54,7 @@ class Print
     
     size_t print(const __FlashStringHelper *);
     size_t print(const String &);
+    size_t print(const StringView &);
     size_t print(const char[]);
     size_t print(char);
     size_t print(unsigned char, int = DEC);
@@ -66,6 +67,7 @@ class Print
 
     size_t println(const __FlashStringHelper *);
     size_t println(const String &s);
+    size_t println(const StringView &);
     size_t println(const char[]);
     size_t println(char);
     size_t println(unsigned char, int = DEC);
@@ -0,0 +1,192 @@
+/*
+  Scheduler.cpp - cooperative task scheduler for the main loop
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include "Arduino.h"
+#include "Scheduler.h"
+
+#if SCHEDULER_SLOTS & (SCHEDULER_SLOTS - 1)
+#error SCHEDULER_SLOTS must be a power of two
+#endif
+
+#define SLOT_MASK (SCHEDULER_SLOTS - 1)
+
+SchedulerClass Scheduler;
+
+// Task ////////////////////////////////////////////////////////////////////////
+
+Task::Task(void (*callback)(void), uint8_t priority)
+{
+  _next = _prev = NULL;
+  _callback = callback;
+  _due = 0;
+  _interval = 0;
+  _priority = priority;
+  _state = IDLE;
+  resetStats();
+}
+
+void Task::resetStats(void)
+{
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+// Private Methods /////////////////////////////////////////////////////////////
+
+// the list a scheduled task is on
+Task *&SchedulerClass::listOf(Task *task)
+{
+  return task->_state == Task::READY ? _ready : _wheel[task->_due & SLOT_MASK];
+}
+
+// puts an idle task in the slot for its due time, or on the ready list if
+// that time's slot has already been checked
+void SchedulerClass::link(Task *task, unsigned long due)
+{
+  task->_due = due;
+  if ((long)(due - _time) <= 0) {
+    makeReady(task);
+    return;
+  }
+
+  Task *&slot = _wheel[due & SLOT_MASK];
+  task->_prev = NULL;
+  task->_next = slot;
+  if (slot) slot->_prev = task;
+  slot = task;
+  task->_state = Task::WAITING;
+}
+
+// puts an idle task on the ready list, after the tasks of the same or
+// higher priority
+void SchedulerClass::makeReady(Task *task)
+{
+  Task *before = NULL;
+  Task *after = _ready;
+  while (after && after->_priority >= task->_priority) {
+    before = after;
+    after = after->_next;
+  }
+  task->_prev = before;
+  task->_next = after;
+  if (after) after->_prev = task;
+  if (before) before->_next = task;
+  else _ready = task;
+  task->_state = Task::READY;
+}
+
+void SchedulerClass::unlink(Task *task)
+{
+  if (task->_prev) task->_prev->_next = task->_next;
+  else listOf(task) = task->_next;
+  if (task->_next) task->_next->_prev = task->_prev;
+  task->_next = task->_prev = NULL;
+  task->_state = Task::IDLE;
+}
+
+// moves the tasks that are due by now onto the ready list.  each
+// millisecond has its own slot, so this only looks at the tasks filed
+// under the milliseconds that have passed since the last call.
+void SchedulerClass::advance(unsigned long now)
+{
+  // after a long gap, one turn of the wheel covers every slot
+  if (now - _time > SCHEDULER_SLOTS)
+    _time = now - SCHEDULER_SLOTS;
+
+  while (_time != now) {
+    _time++;
+    Task *task = _wheel[_time & SLOT_MASK];
+    while (task) {
+      Task *next = task->_next;
+      // tasks due on a later turn of the wheel stay where they are
+      if ((long)(task->_due - now) <= 0) {
+        unlink(task);
+        makeReady(task);
+      }
+      task = next;
+    }
+  }
+}
+
+// Public Methods //////////////////////////////////////////////////////////////
+
+SchedulerClass::SchedulerClass()
+{
+  memset(_wheel, 0, sizeof(_wheel));
+  _ready = NULL;
+  _time = 0;
+  _tasks = 0;
+}
+
+void SchedulerClass::start(Task &task, unsigned long delay, unsigned long interval)
+{
+  if (task._state != Task::IDLE) unlink(&task);
+  else _tasks++;
+  task._interval = interval;
+  link(&task, millis() + delay);
+}
+
+void SchedulerClass::stop(Task &task)
+{
+  if (task._state != Task::IDLE) {
+    unlink(&task);
+    _tasks--;
+  }
+}
+
+void SchedulerClass::run(void)
+{
+  if (_tasks == 0) return;
+
+  unsigned long now = millis();
+  advance(now);
+
+  // periodic tasks are always rescheduled into the future, so this ends
+  // once the tasks that were due have run
+  while (_ready) {
+    Task *task = _ready;
+    unsigned long late = now - task->_due;
+    unlink(task);
+
+    // reschedule before running, so that the task can stop itself.  if it
+    // has fallen a whole interval behind, the missed runs are skipped.
+    if (task->_interval) {
+      unsigned long due = task->_due + task->_interval;
+      if ((long)(due - now) <= 0) due = now + task->_interval;
+      link(task, due);
+    } else {
+      _tasks--;
+    }
+
+    unsigned long start = micros();
+    task->_callback();
+    unsigned long elapsed = micros() - start;
+
+    TaskStats &stats = task->_stats;
+    stats.runs++;
+    stats.totalMicros += elapsed;
+    if (elapsed > stats.maxMicros) stats.maxMicros = elapsed;
+    if (late > stats.maxLate) stats.maxLate = late;
+  }
+}
+
+void schedulerRun(void)
+{
+  Scheduler.run();
+}
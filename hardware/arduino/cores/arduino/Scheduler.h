@@ -0,0 +1,109 @@
+/*
+  Scheduler.h - cooperative task scheduler for the main loop
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef Scheduler_h
+#define Scheduler_h
+
+#include <inttypes.h>
+
+// Number of slots in the timer wheel (a power of two).  A task waits in
+// the slot for the millisecond it's due, so a task due within this many
+// milliseconds is only looked at once it's due; one due later is looked at
+// once per turn of the wheel.
+#ifndef SCHEDULER_SLOTS
+#define SCHEDULER_SLOTS 16
+#endif
+
+struct TaskStats
+{
+  unsigned long runs;         // number of times the task has run
+  unsigned long totalMicros;  // time spent running it, in microseconds
+  unsigned long maxMicros;    // longest single run, in microseconds
+  unsigned long maxLate;      // most milliseconds a run started after it was due
+};
+
+// A function for the scheduler to call, once or at a fixed interval.
+// Tasks are run from the main loop between calls to loop(), never from an
+// interrupt, so they don't need to protect the data they share with it.
+// Arduino.h doesn't include this header, so a sketch that uses the
+// scheduler includes it itself (and names such as Task stay free for
+// libraries otherwise):
+//
+//   #include <Scheduler.h>
+//
+//   void blink() { digitalWrite(13, !digitalRead(13)); }
+//   Task blinkTask(blink);
+//
+//   void setup() {
+//     pinMode(13, OUTPUT);
+//     Scheduler.start(blinkTask, 0, 500);  // now, then every 500 ms
+//   }
+class Task
+{
+  friend class SchedulerClass;
+  private:
+    enum { IDLE, WAITING, READY };
+    Task *_next;                  // in a slot of the wheel or the ready list
+    Task *_prev;
+    void (*_callback)(void);
+    unsigned long _due;           // millis() when the task is next due
+    unsigned long _interval;      // 0 for a one-shot task
+    uint8_t _priority;
+    uint8_t _state;
+    TaskStats _stats;
+  public:
+    // tasks that are due at the same time run highest priority first
+    Task(void (*callback)(void), uint8_t priority = 0);
+    bool isScheduled(void) const { return _state != IDLE; }
+    uint8_t priority(void) const { return _priority; }
+    TaskStats stats(void) const { return _stats; }
+    void resetStats(void);
+};
+
+class SchedulerClass
+{
+  private:
+    Task *_wheel[SCHEDULER_SLOTS];
+    Task *_ready;                 // due tasks, highest priority first
+    unsigned long _time;          // the last millisecond whose slot has been checked
+    unsigned int _tasks;          // number of tasks scheduled
+    Task *&listOf(Task *task);
+    void link(Task *task, unsigned long due);
+    void makeReady(Task *task);
+    void unlink(Task *task);
+    void advance(unsigned long now);
+  public:
+    SchedulerClass();
+    // runs the task after delay milliseconds, then every interval
+    // milliseconds (or just once if interval is 0).  starting a task that's
+    // already scheduled reschedules it.  neither start() nor stop() may be
+    // called from an interrupt handler.
+    void start(Task &task, unsigned long delay, unsigned long interval = 0);
+    void stop(Task &task);
+    // runs the tasks that are due; called after each loop()
+    void run(void);
+};
+
+extern SchedulerClass Scheduler;
+
+// calls Scheduler.run() after each loop(); only linked in, like the
+// scheduler itself, when the sketch uses it
+extern void schedulerRun(void) __attribute__((weak));
+
+#endif
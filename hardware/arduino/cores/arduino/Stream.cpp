@@ -75,7 +75,7 @@ void Stream::setTimeout(unsigned long timeout)  // sets the maximum number of mi
  // find returns true if the target string is found
 bool  Stream::find(char *target)
 {
-  return findUntil(target, NULL);
+  return findUntil(target, strlen(target), NULL, 0);
 }
 
 // reads data from the stream until the target string of given length is found
@@ -96,34 +96,93 @@ bool  Stream::findUntil(char *target, char *terminator)
 // returns true if target string is found, false if terminated or timed out
 bool Stream::findUntil(char *target, size_t targetLen, char *terminator, size_t termLen)
 {
-  size_t index = 0;  // maximum target string length is 64k bytes!
-  size_t termIndex = 0;
-  int c;
-  
-  if( *target == 0)
-    return true;   // return true if target is a null string
-  while( (c = timedRead()) > 0){
-    
-    if(c != target[index])
-      index = 0; // reset index if any char does not match
-    
-    if( c == target[index]){
-      //////Serial.print("found "); Serial.write(c); Serial.print("index now"); Serial.println(index+1);
-      if(++index >= targetLen){ // return true if all chars in the target match
-        return true;
-      }
-    }
-    
-    if(termLen > 0 && c == terminator[termIndex]){
-      if(++termIndex >= termLen)
-        return false;       // return false if terminate string found before target string
+  MultiTarget t[2] = {
+    { target, targetLen, 0, NULL, false },
+    { terminator, termLen, 0, NULL, false }
+  };
+  return findMulti(t, termLen > 0 ? 2 : 1) == 0;
+}
+
+// returns the character at position i of a search target
+static inline uint8_t targetChar(const Stream::MultiTarget *t, size_t i)
+{
+  return t->progmem ? pgm_read_byte(t->str + i) : (uint8_t)t->str[i];
+}
+
+// returns the length of the longest proper prefix of the target that is
+// also a suffix of its first k characters, i.e. how many characters are
+// still matched when the next one doesn't fit
+static size_t fallback(const Stream::MultiTarget *t, size_t k)
+{
+  if (t->fail)
+    return t->progmem ? pgm_read_byte(t->fail + k - 1) : t->fail[k - 1];
+
+  // no table: try the candidates from longest to shortest
+  for (size_t b = k - 1; b > 0; b--) {
+    size_t i = 0;
+    while (i < b && targetChar(t, i) == targetChar(t, k - b + i))
+      i++;
+    if (i == b)
+      return b;
+  }
+  return 0;
+}
+
+// searches for all targets in a single pass, keeping track of the partial
+// match of each one (Knuth-Morris-Pratt), so that no match is missed even
+// if it overlaps with a failed attempt (e.g. "aab" in "aaab")
+int Stream::findMulti(MultiTarget *targets, int tCount)
+{
+  for (MultiTarget *t = targets; t < targets + tCount; ++t) {
+    if (t->len == 0)
+      return t - targets;   // a null string is always found
+    t->index = 0;
+  }
+
+  while (1) {
+    int c = timedRead();
+    if (c < 0)
+      return -1;
+
+    for (MultiTarget *t = targets; t < targets + tCount; ++t) {
+      while (t->index > 0 && c != targetChar(t, t->index))
+        t->index = fallback(t, t->index);
+
+      if (c == targetChar(t, t->index) && ++t->index == t->len)
+        return t - targets;
     }
-    else
-      termIndex = 0;
   }
-  return false;
 }
 
+// computes the failure table of a target: table[i] is the length of the
+// longest proper prefix of str that is also a suffix of str[0..i]
+void Stream::failureTable(const char *str, size_t len, uint8_t *table)
+{
+  if (len == 0) return;
+
+  uint8_t k = 0;
+  table[0] = 0;
+  for (size_t i = 1; i < len; i++) {
+    while (k > 0 && str[i] != str[k])
+      k = table[k - 1];
+    if (str[i] == str[k])
+      k++;
+    table[i] = k;
+  }
+}
+
+// reads the bytes that are already available, one at a time; streams that
+// can move a whole block at once override this
+int Stream::read(uint8_t *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0) break;
+    buffer[count++] = (uint8_t)c;
+  }
+  return count;
+}
 
 // returns the first valid (long) integer value from the current position.
 // initial characters that are not digits (or the minus sign) are skipped
@@ -217,11 +276,20 @@ float Stream::parseFloat(char skipChar){
 size_t Stream::readBytes(char *buffer, size_t length)
 {
   size_t count = 0;
+  bool waiting = false;
   while (count < length) {
-    int c = timedRead();
-    if (c < 0) break;
-    *buffer++ = (char)c;
-    count++;
+    int n = read((uint8_t *)buffer + count, length - count);
+    if (n > 0) {
+      count += n;
+      waiting = false;
+    } else if (!waiting) {
+      // the timeout only starts once the stream runs dry, so millis()
+      // isn't called for every byte
+      _startMillis = millis();
+      waiting = true;
+    } else if (millis() - _startMillis >= _timeout) {
+      break;
+    }
   }
   return count;
 }
@@ -235,9 +303,22 @@ size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
 {
   if (length < 1) return 0;
   size_t index = 0;
+  bool waiting = false;
   while (index < length) {
-    int c = timedRead();
-    if (c < 0 || c == terminator) break;
+    // a bulk read could go past the terminator, so read a byte at a time,
+    // but only start the timeout when the stream runs dry (as readBytes)
+    int c = read();
+    if (c < 0) {
+      if (!waiting) {
+        _startMillis = millis();
+        waiting = true;
+      } else if (millis() - _startMillis >= _timeout) {
+        break;
+      }
+      continue;
+    }
+    waiting = false;
+    if (c == terminator) break;
     *buffer++ = (char)c;
     index++;
   }
@@ -49,6 +49,8 @@ class Stream : public Print
     virtual int read() = 0;
     virtual int peek() = 0;
     virtual void flush() = 0;
+    virtual int read(uint8_t *buffer, size_t length);  // reads up to length bytes without waiting
+    // returns the number of bytes placed in buffer (0, or -1 for some streams, if none were available)
 
     Stream() {_timeout=1000;}
 
@@ -66,6 +68,22 @@ class Stream : public Print
 
   bool findUntil(char *target, size_t targetLen, char *terminate, size_t termLen);   // as above but search ends if the terminate string is found
 
+  // a search target for findMulti()
+  struct MultiTarget {
+    const char *str;      // string you're searching for
+    size_t len;           // length of string you're searching for
+    size_t index;         // used by the search: number of characters matched so far
+    const uint8_t *fail;  // optional failure table from failureTable() (len entries), speeds up the search; may be NULL
+    bool progmem;         // true if str and fail are stored in PROGMEM
+  };
+
+  int findMulti(MultiTarget *targets, int tCount);  // reads data from the stream until one of the targets is found
+  // returns the index of the target that was found first, or -1 if timed out.
+  // all targets are searched for in a single pass, overlapping matches are found too
+
+  static void failureTable(const char *str, size_t len, uint8_t *table);  // computes the failure table of a target
+  // (at most 255 characters) into table, which must hold len entries
+
 
   long parseInt(); // returns the first valid (long) integer value from the current position.
   // initial characters that are not digits (or the minus sign) are skipped
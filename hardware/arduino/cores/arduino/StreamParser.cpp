@@ -0,0 +1,156 @@
+/*
+  StreamParser.cpp - non-blocking versions of the Stream parsing methods
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "StreamParser.h"
+
+// parser states
+#define STATE_SKIPPING 0  // looking for the start of the number
+#define STATE_SIGN     1  // read a minus sign, a digit must follow
+#define STATE_NUMBER   2  // reading digits
+#define STATE_DONE     3
+#define STATE_ERROR    4
+
+// IntParser ///////////////////////////////////////////////////////////////////
+
+IntParser::IntParser(char skipChar)
+{
+  _skipChar = skipChar;
+  reset();
+}
+
+void IntParser::reset(void)
+{
+  _value = 0;
+  _negative = false;
+  _state = STATE_SKIPPING;
+}
+
+ParseStatus IntParser::parse(Stream &stream)
+{
+  while (_state < STATE_DONE) {
+    int c = stream.peek();
+    if (c < 0) return PARSE_MORE;
+
+    if (c >= '0' && c <= '9') {
+      _value = _value * 10 + c - '0';
+      _state = STATE_NUMBER;
+    } else if (_state == STATE_SKIPPING) {
+      if (c == '-') {
+        _negative = true;
+        _state = STATE_SIGN;
+      }
+    } else if (c != _skipChar) {
+      // the number ends here; leave the character in the stream
+      _state = _state == STATE_NUMBER ? STATE_DONE : STATE_ERROR;
+      break;
+    }
+    stream.read();
+  }
+  return _state == STATE_DONE ? PARSE_DONE : PARSE_ERROR;
+}
+
+// FloatParser /////////////////////////////////////////////////////////////////
+
+FloatParser::FloatParser(char skipChar)
+{
+  _skipChar = skipChar;
+  reset();
+}
+
+void FloatParser::reset(void)
+{
+  _value = 0;
+  _fraction = 1.0;
+  _negative = false;
+  _isFraction = false;
+  _state = STATE_SKIPPING;
+}
+
+ParseStatus FloatParser::parse(Stream &stream)
+{
+  while (_state < STATE_DONE) {
+    int c = stream.peek();
+    if (c < 0) return PARSE_MORE;
+
+    if (c >= '0' && c <= '9') {
+      _value = _value * 10 + c - '0';
+      if (_isFraction)
+        _fraction *= 0.1;
+      _state = STATE_NUMBER;
+    } else if (_state == STATE_SKIPPING) {
+      if (c == '-') {
+        _negative = true;
+        _state = STATE_SIGN;
+      }
+    } else if (c == '.') {
+      _isFraction = true;
+    } else if (c != _skipChar) {
+      // the number ends here; leave the character in the stream
+      _state = _state == STATE_NUMBER ? STATE_DONE : STATE_ERROR;
+      break;
+    }
+    stream.read();
+  }
+  return _state == STATE_DONE ? PARSE_DONE : PARSE_ERROR;
+}
+
+float FloatParser::value(void)
+{
+  long value = _negative ? -_value : _value;
+  if (_isFraction)
+    return value * _fraction;
+  else
+    return value;
+}
+
+// BytesUntilParser ////////////////////////////////////////////////////////////
+
+BytesUntilParser::BytesUntilParser(char terminator, char *buffer, size_t length)
+{
+  _terminator = terminator;
+  _buffer = buffer;
+  _length = length;
+  reset();
+}
+
+void BytesUntilParser::reset(void)
+{
+  _count = 0;
+  _done = false;
+}
+
+ParseStatus BytesUntilParser::parse(Stream &stream)
+{
+  if (_length < 1) return PARSE_ERROR;
+
+  while (!_done) {
+    if (_count >= _length) {
+      _done = true;
+      break;
+    }
+    int c = stream.read();
+    if (c < 0) return PARSE_MORE;
+    if (c == _terminator)
+      _done = true;
+    else
+      _buffer[_count++] = (char)c;
+  }
+  return PARSE_DONE;
+}
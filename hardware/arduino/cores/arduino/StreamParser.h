@@ -0,0 +1,98 @@
+/*
+  StreamParser.h - non-blocking versions of the Stream parsing methods
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef StreamParser_h
+#define StreamParser_h
+
+#include <inttypes.h>
+#include "Stream.h"
+
+// Stream::parseInt(), parseFloat() and readBytesUntil() wait for data
+// until the stream times out.  These parsers instead take whatever bytes
+// are available each time parse() is called, keep their state in between,
+// and report how far they got, so that a sketch can parse several streams
+// at once from loop():
+//
+//   IntParser speed;
+//   ...
+//   if (speed.parse(Serial) == PARSE_DONE) {
+//     motor(speed.value());
+//     speed.reset();
+//   }
+
+enum ParseStatus {
+  PARSE_MORE,   // all available data consumed, call parse() again later
+  PARSE_DONE,   // a complete value was read
+  PARSE_ERROR   // the data didn't form a valid value
+};
+
+// as Stream::parseInt(): leading characters that are not digits (or the
+// minus sign) are skipped, the number ends at the first character that is
+// not a digit, which is left in the stream.  skipChar is ignored inside
+// the number (e.g. thousands separators).
+class IntParser
+{
+  private:
+    long _value;
+    char _skipChar;
+    uint8_t _state;
+    bool _negative;
+  public:
+    IntParser(char skipChar = 1);
+    void reset(void);
+    ParseStatus parse(Stream &stream);
+    long value(void) { return _negative ? -_value : _value; }
+};
+
+// as IntParser, but the number may also contain a decimal point
+class FloatParser
+{
+  private:
+    long _value;
+    float _fraction;
+    char _skipChar;
+    uint8_t _state;
+    bool _negative;
+    bool _isFraction;
+  public:
+    FloatParser(char skipChar = 1);
+    void reset(void);
+    ParseStatus parse(Stream &stream);
+    float value(void);
+};
+
+// as Stream::readBytesUntil(): stores characters into buffer until the
+// terminator (which is consumed but not stored) is read or the buffer is
+// full.  The buffer is NOT null terminated.
+class BytesUntilParser
+{
+  private:
+    char *_buffer;
+    size_t _length;
+    size_t _count;
+    char _terminator;
+    bool _done;
+  public:
+    BytesUntilParser(char terminator, char *buffer, size_t length);
+    void reset(void);
+    ParseStatus parse(Stream &stream);
+    size_t count(void) { return _count; }  // number of characters in the buffer
+};
+
+#endif
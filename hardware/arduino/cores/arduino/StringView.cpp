@@ -0,0 +1,197 @@
+/*
+  StringView.cpp - non-owning reference to a piece of text in RAM or flash
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <string.h>
+#include <ctype.h>
+#include "WString.h"
+
+/*********************************************/
+/*  Constructors                             */
+/*********************************************/
+
+StringView::StringView(const char *cstr)
+{
+	_data = cstr;
+	_len = cstr ? strlen(cstr) : 0;
+	_flash = false;
+}
+
+StringView::StringView(const __FlashStringHelper *str)
+{
+	_data = (const char *)str;
+	_len = str ? strlen_P(_data) : 0;
+	_flash = true;
+}
+
+StringView::StringView(const String &str)
+{
+	_data = str.c_str();
+	_len = str.length();
+	_flash = false;
+}
+
+/*********************************************/
+/*  Character Access                         */
+/*********************************************/
+
+char StringView::charAt(unsigned int index) const
+{
+	if (index >= _len) return 0;
+	if (_flash) return pgm_read_byte(_data + index);
+	return _data[index];
+}
+
+/*********************************************/
+/*  Comparison                               */
+/*********************************************/
+
+// true if s appears at offset in this view (which must have room for it)
+unsigned char StringView::matches(unsigned int offset, const StringView &s, bool ignoreCase) const
+{
+	if (!ignoreCase && !_flash && !s._flash)
+		return memcmp(_data + offset, s._data, s._len) == 0;
+	for (unsigned int i = 0; i < s._len; i++) {
+		char a = charAt(offset + i);
+		char b = s.charAt(i);
+		if (ignoreCase) {
+			a = tolower(a);
+			b = tolower(b);
+		}
+		if (a != b) return 0;
+	}
+	return 1;
+}
+
+unsigned char StringView::equals(const StringView &s) const
+{
+	return _len == s._len && matches(0, s, false);
+}
+
+unsigned char StringView::equalsIgnoreCase(const StringView &s) const
+{
+	return _len == s._len && matches(0, s, true);
+}
+
+unsigned char StringView::startsWith(const StringView &prefix) const
+{
+	return _len >= prefix._len && matches(0, prefix, false);
+}
+
+unsigned char StringView::endsWith(const StringView &suffix) const
+{
+	return _len >= suffix._len && matches(_len - suffix._len, suffix, false);
+}
+
+/*********************************************/
+/*  Search                                   */
+/*********************************************/
+
+int StringView::indexOf(char ch, unsigned int fromIndex) const
+{
+	if (fromIndex >= _len) return -1;
+	const char *found;
+	if (_flash)
+		found = (const char *)memchr_P(_data + fromIndex, ch, _len - fromIndex);
+	else
+		found = (const char *)memchr(_data + fromIndex, ch, _len - fromIndex);
+	if (found == NULL) return -1;
+	return found - _data;
+}
+
+int StringView::indexOf(const StringView &s, unsigned int fromIndex) const
+{
+	if (s._len > _len) return -1;
+	for (unsigned int i = fromIndex; i <= _len - s._len; i++) {
+		if (matches(i, s, false)) return i;
+	}
+	return -1;
+}
+
+int StringView::lastIndexOf(char ch) const
+{
+	for (unsigned int i = _len; i > 0; i--) {
+		if (charAt(i - 1) == ch) return i - 1;
+	}
+	return -1;
+}
+
+StringView StringView::substring(unsigned int left) const
+{
+	return substring(left, _len);
+}
+
+StringView StringView::substring(unsigned int left, unsigned int right) const
+{
+	if (left > right) {
+		unsigned int temp = right;
+		right = left;
+		left = temp;
+	}
+	if (right > _len) right = _len;
+	if (left > right) left = right;
+	return StringView(_data + left, right - left, _flash);
+}
+
+StringView StringView::trim(void) const
+{
+	unsigned int begin = 0, end = _len;
+	while (begin < end && isspace(charAt(begin))) begin++;
+	while (end > begin && isspace(charAt(end - 1))) end--;
+	return StringView(_data + begin, end - begin, _flash);
+}
+
+unsigned char StringView::split(char separator, StringView &token)
+{
+	if (!_data) return 0;
+	int index = indexOf(separator);
+	if (index < 0) {
+		// last token: the whole remaining view
+		token = *this;
+		_data = NULL;
+		_len = 0;
+	} else {
+		token = StringView(_data, index, _flash);
+		_data += index + 1;
+		_len -= index + 1;
+	}
+	return 1;
+}
+
+/*********************************************/
+/*  Parsing / Conversion                     */
+/*********************************************/
+
+// as atol(): leading white space, then an optional sign and the digits
+long StringView::toInt(void) const
+{
+	unsigned int i = 0;
+	while (i < _len && isspace(charAt(i))) i++;
+	bool negative = false;
+	if (i < _len && (charAt(i) == '-' || charAt(i) == '+')) {
+		negative = charAt(i) == '-';
+		i++;
+	}
+	long value = 0;
+	for (; i < _len; i++) {
+		char c = charAt(i);
+		if (c < '0' || c > '9') break;
+		value = value * 10 + c - '0';
+	}
+	return negative ? -value : value;
+}
@@ -0,0 +1,93 @@
+/*
+  StringView.h - non-owning reference to a piece of text in RAM or flash
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef StringView_h
+#define StringView_h
+#ifdef __cplusplus
+
+#include <stddef.h>
+#include <avr/pgmspace.h>
+
+class String;
+class __FlashStringHelper;
+
+// A StringView points at characters stored elsewhere (a char array, a
+// String, or an F() string in flash) without copying them.  Searching,
+// comparing and splitting a view never allocates memory; substring() and
+// split() just return narrower views of the same characters.
+//
+// The view doesn't own the characters: it must not outlive them, and it
+// becomes invalid if the String it refers to is modified.
+//
+//   StringView rest(requestLine), token;
+//   while (rest.split(' ', token)) {
+//     if (token.equals(F("GET"))) ...
+//   }
+class StringView
+{
+public:
+	// constructors
+	StringView() : _data(NULL), _len(0), _flash(false) {}
+	StringView(const char *cstr);
+	StringView(const char *data, unsigned int length, bool flash = false)
+		: _data(data), _len(length), _flash(flash) {}
+	StringView(const __FlashStringHelper *str);
+	StringView(const String &str);
+
+	inline unsigned int length(void) const {return _len;}
+	inline bool isFlash(void) const {return _flash;}
+	// the characters (in PROGMEM if isFlash()); not null terminated
+	inline const char *data(void) const {return _data;}
+
+	// character access
+	char charAt(unsigned int index) const;
+	char operator [] (unsigned int index) const {return charAt(index);}
+
+	// comparison
+	unsigned char equals(const StringView &s) const;
+	unsigned char equalsIgnoreCase(const StringView &s) const;
+	unsigned char startsWith(const StringView &prefix) const;
+	unsigned char endsWith(const StringView &suffix) const;
+
+	// search
+	int indexOf(char ch, unsigned int fromIndex = 0) const;
+	int indexOf(const StringView &str, unsigned int fromIndex = 0) const;
+	int lastIndexOf(char ch) const;
+	StringView substring(unsigned int beginIndex) const;
+	StringView substring(unsigned int beginIndex, unsigned int endIndex) const;
+	StringView trim(void) const;
+
+	// splitting: puts the text up to the next separator into token and
+	// removes it (and the separator) from this view.  returns false once
+	// the last token has been taken.
+	unsigned char split(char separator, StringView &token);
+
+	// parsing/conversion
+	long toInt(void) const;
+
+private:
+	const char *_data;
+	unsigned int _len;
+	bool _flash;
+
+	unsigned char matches(unsigned int offset, const StringView &s, bool ignoreCase) const;
+};
+
+#endif  // __cplusplus
+#endif  // StringView_h
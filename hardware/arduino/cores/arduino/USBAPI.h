@@ -25,6 +25,8 @@ extern USBDevice_ USBDevice;
 //================================================================================
 //	Serial over CDC (Serial1 is the physical port)
 
+struct ring_buffer;
+
 class Serial_ : public Stream
 {
 private:
@@ -38,6 +40,11 @@ public:
 	virtual void accept(void);
 	virtual int peek(void);
 	virtual int read(void);
+	virtual int read(uint8_t *buffer, size_t length);
+	size_t peekBuffer(const uint8_t **data);	// see HardwareSerial.h
+	void consume(size_t n);
+	SerialStats stats();
+	void resetStats();
 	virtual void flush(void);
 	virtual size_t write(uint8_t);
 	using Print::write; // pull in write(str) and write(buf, size) from Print
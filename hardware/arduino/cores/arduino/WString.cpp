@@ -20,6 +20,9 @@
 */
 
 #include "WString.h"
+#include "MemoryPool.h"
+
+BlockPool *String::pool = NULL;
 
 
 /*********************************************/
@@ -38,6 +41,14 @@ String::String(const String &value)
 	*this = value;
 }
 
+// a concatenation result is a temporary that's about to be destroyed, so
+// (as with the rvalue constructors) its buffer is taken rather than copied
+String::String(const StringSumHelper &rval)
+{
+	init();
+	move(const_cast<StringSumHelper&>(rval));
+}
+
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
 String::String(String &&rval)
 {
@@ -51,6 +62,12 @@ String::String(StringSumHelper &&rval)
 }
 #endif
 
+String::String(const StringView &view)
+{
+	init();
+	if (reserve(view.length())) concat(view);
+}
+
 String::String(char c)
 {
 	init();
@@ -115,7 +132,7 @@ String::String(double value, int decimalPlaces)
 }
 String::~String()
 {
-	free(buffer);
+	releaseBuffer();
 }
 
 /*********************************************/
@@ -132,7 +149,7 @@ inline void String::init(void)
 
 void String::invalidate(void)
 {
-	if (buffer) free(buffer);
+	releaseBuffer();
 	buffer = NULL;
 	capacity = len = 0;
 }
@@ -149,13 +166,57 @@ unsigned char String::reserve(unsigned int size)
 
 unsigned char String::changeBuffer(unsigned int maxStrLen)
 {
-	char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
-	if (newbuffer) {
-		buffer = newbuffer;
-		capacity = maxStrLen;
+	#if STRING_SMALL_SIZE > 0
+	if (!buffer && maxStrLen < STRING_SMALL_SIZE) {
+		buffer = smallBuffer;
+		capacity = STRING_SMALL_SIZE - 1;
 		return 1;
 	}
-	return 0;
+	#endif
+	char *newbuffer = NULL;
+	unsigned int newcapacity = maxStrLen;
+	if (pool && maxStrLen < pool->blockSize()) {
+		newbuffer = (char *)pool->allocate();
+		if (newbuffer) newcapacity = pool->blockSize() - 1;
+	}
+	if (!newbuffer) {
+		if (buffer && !isSmall() && !(pool && pool->owns(buffer))) {
+			// a heap buffer can be resized in place
+			newbuffer = (char *)realloc(buffer, maxStrLen + 1);
+			if (!newbuffer) return 0;
+			buffer = newbuffer;
+			capacity = maxStrLen;
+			return 1;
+		}
+		newbuffer = (char *)malloc(maxStrLen + 1);
+		if (!newbuffer) return 0;
+	}
+	// moving out of the inline buffer, or between the pool and the heap
+	if (buffer) memcpy(newbuffer, buffer, len + 1);
+	releaseBuffer();
+	buffer = newbuffer;
+	capacity = newcapacity;
+	return 1;
+}
+
+// frees the buffer, wherever it came from
+void String::releaseBuffer(void)
+{
+	if (isSmall()) return;
+	if (pool && pool->owns(buffer)) pool->release(buffer);
+	else free(buffer);
+}
+
+// as reserve, but leaves room to spare for further concatenations
+unsigned char String::grow(unsigned int size)
+{
+	if (buffer && capacity >= size) return 1;
+	if (buffer) {
+		unsigned int extra = capacity < STRING_MAX_GROWTH ? capacity : STRING_MAX_GROWTH;
+		if (capacity + extra > size && reserve(capacity + extra)) return 1;
+	}
+	// not growing geometrically, or there's no memory for the spare room
+	return reserve(size);
 }
 
 /*********************************************/
@@ -173,9 +234,13 @@ String & String::copy(const char *cstr, unsigned int length)
 	return *this;
 }
 
-#ifdef __GXX_EXPERIMENTAL_CXX0X__
 void String::move(String &rhs)
 {
+	if (!rhs.buffer) {
+		// e.g. a concatenation that ran out of memory
+		invalidate();
+		return;
+	}
 	if (buffer) {
 		if (capacity >= rhs.len) {
 			strcpy(buffer, rhs.buffer);
@@ -183,9 +248,17 @@ void String::move(String &rhs)
 			rhs.len = 0;
 			return;
 		} else {
-			free(buffer);
+			releaseBuffer();
 		}
 	}
+	if (rhs.isSmall()) {
+		// the inline buffer can't be handed over, copy it instead
+		buffer = NULL;
+		copy(rhs.buffer, rhs.len);
+		rhs.len = 0;
+		rhs.buffer[0] = 0;
+		return;
+	}
 	buffer = rhs.buffer;
 	capacity = rhs.capacity;
 	len = rhs.len;
@@ -193,7 +266,6 @@ void String::move(String &rhs)
 	rhs.capacity = 0;
 	rhs.len = 0;
 }
-#endif
 
 String & String::operator = (const String &rhs)
 {
@@ -205,6 +277,12 @@ String & String::operator = (const String &rhs)
 	return *this;
 }
 
+String & String::operator = (const StringSumHelper &rval)
+{
+	if (this != &rval) move(const_cast<StringSumHelper&>(rval));
+	return *this;
+}
+
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
 String & String::operator = (String &&rval)
 {
@@ -241,7 +319,7 @@ unsigned char String::concat(const char *cstr, unsigned int length)
 	unsigned int newlen = len + length;
 	if (!cstr) return 0;
 	if (length == 0) return 1;
-	if (!reserve(newlen)) return 0;
+	if (!grow(newlen)) return 0;
 	strcpy(buffer + len, cstr);
 	len = newlen;
 	return 1;
@@ -253,6 +331,18 @@ unsigned char String::concat(const char *cstr)
 	return concat(cstr, strlen(cstr));
 }
 
+unsigned char String::concat(const StringView &view)
+{
+	unsigned int length = view.length();
+	if (length == 0) return 1;
+	if (!grow(len + length)) return 0;
+	if (view.isFlash()) memcpy_P(buffer + len, view.data(), length);
+	else memcpy(buffer + len, view.data(), length);
+	len += length;
+	buffer[len] = 0;
+	return 1;
+}
+
 unsigned char String::concat(char c)
 {
 	char buf[2];
@@ -328,6 +418,13 @@ StringSumHelper & operator + (const StringSumHelper &lhs, const char *cstr)
 	return a;
 }
 
+StringSumHelper & operator + (const StringSumHelper &lhs, const StringView &view)
+{
+	StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
+	if (!a.concat(view)) a.invalidate();
+	return a;
+}
+
 StringSumHelper & operator + (const StringSumHelper &lhs, char c)
 {
 	StringSumHelper &a = const_cast<StringSumHelper&>(lhs);
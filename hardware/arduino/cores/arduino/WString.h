@@ -27,6 +27,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <avr/pgmspace.h>
+#include "StringView.h"
 
 // When compiling programs with this class, the following gcc parameters
 // dramatically increase performance and memory (RAM) efficiency, typically
@@ -34,7 +35,22 @@
 //     -felide-constructors
 //     -std=c++0x
 
+// Strings shorter than this are kept in a buffer inside the String object
+// itself rather than on the heap.  Can be set on the compiler command line
+// (or in the variant's pins_arduino.h); 0 disables the inline buffer.
+#ifndef STRING_SMALL_SIZE
+#define STRING_SMALL_SIZE 8
+#endif
+
+// When a concatenation needs more room, the buffer is grown to twice its
+// size (but by no more than this many bytes) so that building a String
+// piece by piece doesn't reallocate it every time.
+#ifndef STRING_MAX_GROWTH
+#define STRING_MAX_GROWTH 32
+#endif
+
 class __FlashStringHelper;
+class BlockPool;
 #define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
 
 // An inherited class for holding the result of a concatenation.  These
@@ -58,10 +74,12 @@ public:
 	// be false).
 	String(const char *cstr = "");
 	String(const String &str);
+	String(const StringSumHelper &rval);	// takes over the buffer of a concatenation result
 	#ifdef __GXX_EXPERIMENTAL_CXX0X__
 	String(String &&rval);
 	String(StringSumHelper &&rval);
 	#endif
+	explicit String(const StringView &view);
 	explicit String(char c);
 	explicit String(unsigned char, unsigned char base=10);
 	explicit String(int, unsigned char base=10);
@@ -79,11 +97,18 @@ public:
 	unsigned char reserve(unsigned int size);
 	inline unsigned int length(void) const {return len;}
 
+	// makes Strings take their buffer from a block of the given pool
+	// (see MemoryPool.h) whenever it's big enough, and from the heap only
+	// otherwise.  NULL goes back to using the heap only.  don't change the
+	// pool while Strings using blocks of the previous one still exist.
+	static void setPool(BlockPool *blockPool) {pool = blockPool;}
+
 	// creates a copy of the assigned value.  if the value is null or
 	// invalid, or if the memory allocation fails, the string will be 
 	// marked as invalid ("if (s)" will be false).
 	String & operator = (const String &rhs);
 	String & operator = (const char *cstr);
+	String & operator = (const StringSumHelper &rval);
 	#ifdef __GXX_EXPERIMENTAL_CXX0X__
 	String & operator = (String &&rval);
 	String & operator = (StringSumHelper &&rval);
@@ -96,6 +121,7 @@ public:
 	// concatenation is considered unsucessful.  
 	unsigned char concat(const String &str);
 	unsigned char concat(const char *cstr);
+	unsigned char concat(const StringView &view);
 	unsigned char concat(char c);
 	unsigned char concat(unsigned char c);
 	unsigned char concat(int num);
@@ -109,6 +135,7 @@ public:
 	// will be left unchanged (but this isn't signalled in any way)
 	String & operator += (const String &rhs)	{concat(rhs); return (*this);}
 	String & operator += (const char *cstr)		{concat(cstr); return (*this);}
+	String & operator += (const StringView &view)	{concat(view); return (*this);}
 	String & operator += (char c)			{concat(c); return (*this);}
 	String & operator += (unsigned char num)		{concat(num); return (*this);}
 	String & operator += (int num)			{concat(num); return (*this);}
@@ -118,6 +145,7 @@ public:
 
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, const String &rhs);
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, const char *cstr);
+	friend StringSumHelper & operator + (const StringSumHelper &lhs, const StringView &view);
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, char c);
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, unsigned char num);
 	friend StringSumHelper & operator + (const StringSumHelper &lhs, int num);
@@ -185,17 +213,26 @@ protected:
 	unsigned int capacity;  // the array length minus one (for the '\0')
 	unsigned int len;       // the String length (not counting the '\0')
 	unsigned char flags;    // unused, for future features
+	#if STRING_SMALL_SIZE > 0
+	char smallBuffer[STRING_SMALL_SIZE];  // used as buffer for short strings
+	#endif
+	static BlockPool *pool;
 protected:
 	void init(void);
 	void invalidate(void);
+	#if STRING_SMALL_SIZE > 0
+	inline unsigned char isSmall(void) const {return buffer == smallBuffer;}
+	#else
+	inline unsigned char isSmall(void) const {return 0;}
+	#endif
 	unsigned char changeBuffer(unsigned int maxStrLen);
+	void releaseBuffer(void);
+	unsigned char grow(unsigned int maxStrLen);
 	unsigned char concat(const char *cstr, unsigned int length);
 
 	// copy and move
 	String & copy(const char *cstr, unsigned int length);
-	#ifdef __GXX_EXPERIMENTAL_CXX0X__
 	void move(String &rhs);
-	#endif
 };
 
 class StringSumHelper : public String
@@ -18,9 +18,14 @@
 */
 
 #include <Arduino.h>
+#include "Scheduler.h"
 
 int main(void)
 {
+	// fill the free RAM with a pattern, so that memoryStats() can tell how
+	// far the heap and stack have reached into it
+	if (paintFreeMemory) paintFreeMemory();
+
 	init();
 
 #if defined(USBCON)
@@ -32,6 +37,7 @@ int main(void)
 	for (;;) {
 		loop();
 		if (serialEventRun) serialEventRun();
+		if (schedulerRun) schedulerRun();
 	}
         
 	return 0;
@@ -22,6 +22,7 @@
   $Id$
 */
 
+#include <avr/sleep.h>
 #include "wiring_private.h"
 
 // the prescaler is set so that timer0 ticks every 64 clock cycles, and the
@@ -41,6 +42,11 @@ volatile unsigned long timer0_overflow_count = 0;
 volatile unsigned long timer0_millis = 0;
 static unsigned char timer0_fract = 0;
 
+// the upper halves of the 64-bit millis64() and micros64() counts, carried
+// into when the 32-bit counts above wrap around (every 49 days or so)
+static volatile unsigned int timer0_millis_high = 0;
+static volatile unsigned int timer0_overflow_high = 0;
+
 #if defined(__AVR_ATtiny24__) || defined(__AVR_ATtiny44__) || defined(__AVR_ATtiny84__)
 ISR(TIM0_OVF_vect)
 #else
@@ -60,8 +66,11 @@ ISR(TIMER0_OVF_vect)
 	}
 
 	timer0_fract = f;
+	if (m < timer0_millis)
+		timer0_millis_high++;
 	timer0_millis = m;
-	timer0_overflow_count++;
+	if (++timer0_overflow_count == 0)
+		timer0_overflow_high++;
 }
 
 unsigned long millis()
@@ -106,15 +115,94 @@ unsigned long micros() {
 	return ((m << 8) + t) * (64 / clockCyclesPerMicrosecond());
 }
 
+unsigned long long millis64()
+{
+	unsigned long m;
+	unsigned int h;
+	uint8_t oldSREG = SREG;
+
+	cli();
+	m = timer0_millis;
+	h = timer0_millis_high;
+	SREG = oldSREG;
+
+	return ((unsigned long long)h << 32) | m;
+}
+
+unsigned long long micros64() {
+	unsigned long m;
+	unsigned int h;
+	uint8_t oldSREG = SREG, t;
+
+	cli();
+	m = timer0_overflow_count;
+	h = timer0_overflow_high;
+#if defined(TCNT0)
+	t = TCNT0;
+#elif defined(TCNT0L)
+	t = TCNT0L;
+#else
+	#error TIMER 0 not defined
+#endif
+
+	// as in micros(), count an overflow that's pending
+#ifdef TIFR0
+	if ((TIFR0 & _BV(TOV0)) && (t < 255))
+#else
+	if ((TIFR & _BV(TOV0)) && (t < 255))
+#endif
+		if (++m == 0)
+			h++;
+
+	SREG = oldSREG;
+
+	return ((((unsigned long long)h << 32) | m) << 8 | t) * (64 / clockCyclesPerMicrosecond());
+}
+
+// called over and over while delay() waits.  a sketch or library can
+// define its own to get background work done in the meantime, e.g.
+//   void yield() { serialEventRun(); }
+void yield(void) __attribute__ ((weak));
+void yield(void) {}
+
+static uint8_t delay_sleep = 0;
+
+// with enable set, delay() puts the CPU in idle sleep between interrupts
+// instead of polling micros(), which saves power.  timers and peripherals
+// keep running, and any interrupt (at the latest the next timer 0
+// overflow) wakes it up again.
+void delaySleep(uint8_t enable)
+{
+	delay_sleep = enable;
+}
+
 void delay(unsigned long ms)
 {
+	static uint8_t yielding = 0;
 	uint16_t start = (uint16_t)micros();
 
 	while (ms > 0) {
-		if (((uint16_t)micros() - start) >= 1000) {
+		// if yield() itself calls delay(), don't call it again from there
+		if (!yielding) {
+			yielding = 1;
+			yield();
+			yielding = 0;
+		}
+
+		while (ms > 0 && ((uint16_t)micros() - start) >= 1000) {
 			ms--;
 			start += 1000;
 		}
+
+		// a timer 0 overflow wakes us up within 1.024 ms, so stay awake for
+		// the last millisecond to end on time; and never sleep with
+		// interrupts disabled, since nothing would wake us up then
+		if (delay_sleep && ms > 1 && (SREG & _BV(SREG_I))) {
+			set_sleep_mode(SLEEP_MODE_IDLE);
+			sleep_enable();
+			sleep_cpu();
+			sleep_disable();
+		}
 	}
 }
 
@@ -0,0 +1,332 @@
+/*
+  wiring_adc.c - background sampling and oversampling of the analog inputs
+  Part of Arduino - http://www.arduino.cc/
+
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#include "wiring_private.h"
+
+// analogRead() waits for each conversion to finish, about 110 us with the
+// ADC clock set up by init().  The sampler instead has the ADC complete
+// interrupt store each result and move on to the next analog input of a
+// list, so the conversions run while the sketch does something else.
+// The samples of each input collect in a ring buffer of their own until
+// readAnalogSamples() takes them; a sample that finds its buffer full is
+// dropped and counted by analogSamplerOverruns().
+//
+// With a rate, timer 1 starts the conversions at fixed intervals (so PWM
+// on its pins, the cycle counter and libraries such as Servo can't be used
+// meanwhile); without one, each conversion starts as soon as the previous
+// one is done.  analogRead() mustn't be called while the sampler runs.
+//
+// Oversampling reads one input 4^n times from the same interrupt and adds
+// up the results; the sum shifted right by n has n more bits than a single
+// reading.  This only works if the input has some noise on it (at least
+// one step of the ADC), which is usually the case, and each extra bit
+// takes four times as long: 16 bits take 4096 conversions, about half a
+// second with the ADC clock set up by init().  Starting the sampler stops
+// oversampling, and the other way round.
+//
+// This file is only linked into sketches that use it, so it doesn't claim
+// the ADC interrupt otherwise.
+
+#if defined(ADCSRA) && defined(ADCL) && defined(ADIE)
+
+// the most analog inputs sampled at once
+#ifndef ADC_SAMPLER_CHANNELS
+#define ADC_SAMPLER_CHANNELS 8
+#endif
+
+// the number of samples buffered, shared equally among the inputs
+#ifndef ADC_SAMPLER_BUFFER
+#define ADC_SAMPLER_BUFFER 64
+#endif
+
+#if defined(ADATE) && defined(TCCR1B) && defined(OCR1B) && defined(TIFR1)
+#define SAMPLER_TIMER
+#endif
+
+struct sampler_channel
+{
+	uint8_t admux;          // ADMUX setting for the input
+	uint8_t mux5;           // and the MUX5 bit of ADCSRB, if there is one
+	uint8_t start;          // the input's part of the buffer
+	volatile uint8_t head;  // where the next sample goes
+	volatile uint8_t tail;  // the oldest sample not yet read
+};
+
+static struct sampler_channel channels[ADC_SAMPLER_CHANNELS];
+static volatile int samples[ADC_SAMPLER_BUFFER];
+static uint8_t channel_count;
+static uint8_t channel_size;        // samples per input; one place is always left empty
+static volatile uint8_t current;    // the input being converted
+static volatile unsigned int overruns;
+static uint8_t running;
+
+static volatile unsigned int oversample_left;  // conversions still to add up
+static volatile unsigned long oversample_sum;
+static uint8_t oversample_shift;
+
+#ifdef SAMPLER_TIMER
+static uint8_t timed;
+static uint8_t saved_tccr1a, saved_tccr1b;
+static unsigned int saved_ocr1a, saved_ocr1b;
+#endif
+
+static inline void select_channel(const struct sampler_channel *c)
+{
+#if defined(ADCSRB) && defined(MUX5)
+	ADCSRB = (ADCSRB & ~_BV(MUX5)) | c->mux5;
+#endif
+	ADMUX = c->admux;
+}
+
+ISR(ADC_vect)
+{
+	// ADCL must be read first, as in analogRead()
+	uint8_t low = ADCL;
+	uint8_t high = ADCH;
+
+	if (oversample_left) {
+		oversample_sum += (high << 8) | low;
+		if (--oversample_left) sbi(ADCSRA, ADSC);
+		else cbi(ADCSRA, ADIE);
+		return;
+	}
+
+	struct sampler_channel *c = &channels[current];
+	uint8_t next = c->head + 1;
+	if (next == channel_size) next = 0;
+	if (next == c->tail) {
+		overruns++;
+	} else {
+		samples[c->start + c->head] = (high << 8) | low;
+		c->head = next;
+	}
+
+	// on to the next input
+	uint8_t n = current + 1;
+	if (n == channel_count) n = 0;
+	current = n;
+	select_channel(&channels[n]);
+
+#ifdef SAMPLER_TIMER
+	if (timed) {
+		// the next compare match only triggers a conversion once its flag
+		// has been cleared
+		TIFR1 = _BV(OCF1B);
+		return;
+	}
+#endif
+	sbi(ADCSRA, ADSC);
+}
+
+#ifdef SAMPLER_TIMER
+// sets timer 1 to reach a compare match rate times a second
+static void start_timer(unsigned long rate)
+{
+	static const uint8_t shifts[] = { 0, 3, 6, 8, 10 };  // clk/1 to clk/1024
+	unsigned long ticks = F_CPU / rate;
+	uint8_t cs = 0;
+	while (cs < 4 && (ticks >> shifts[cs]) > 65536UL) cs++;
+	ticks >>= shifts[cs];
+	if (ticks > 65536UL) ticks = 65536UL;
+	if (ticks == 0) ticks = 1;
+
+	saved_tccr1a = TCCR1A;
+	saved_tccr1b = TCCR1B;
+	saved_ocr1a = OCR1A;
+	saved_ocr1b = OCR1B;
+
+	// CTC mode, counting up to OCR1A; compare match B at the top of the
+	// count triggers the ADC
+	TCCR1B = 0;
+	TCCR1A = 0;
+	TCNT1 = 0;
+	OCR1A = ticks - 1;
+	OCR1B = ticks - 1;
+	TIFR1 = _BV(OCF1B);
+	ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2) | _BV(ADTS0);
+	TCCR1B = _BV(WGM12) | (cs + 1);
+}
+#endif
+
+static void stop_oversampling(void)
+{
+	cbi(ADCSRA, ADIE);
+	oversample_left = 0;
+	while (bit_is_set(ADCSRA, ADSC));
+}
+
+// starts sampling the given analog inputs, each rate times a second (or
+// as fast as possible if rate is 0)
+void startAnalogSampler(const uint8_t *pins, uint8_t count, unsigned long rate)
+{
+	uint8_t i;
+
+	stopAnalogSampler();
+	stop_oversampling();
+	if (count == 0) return;
+	if (count > ADC_SAMPLER_CHANNELS) count = ADC_SAMPLER_CHANNELS;
+
+	channel_count = count;
+	channel_size = ADC_SAMPLER_BUFFER / count;
+	for (i = 0; i < count; i++) {
+		uint8_t channel = analogInputChannel(pins[i]);
+		struct sampler_channel *c = &channels[i];
+#if defined(ADCSRB) && defined(MUX5)
+		c->mux5 = ((channel >> 3) & 0x01) << MUX5;
+#else
+		c->mux5 = 0;
+#endif
+		c->admux = (analog_reference << 6) | (channel & 0x07);
+		c->start = i * channel_size;
+		c->head = c->tail = 0;
+	}
+	current = 0;
+	overruns = 0;
+	select_channel(&channels[0]);
+
+	// clear a stale completion before enabling the interrupt
+	sbi(ADCSRA, ADIF);
+	sbi(ADCSRA, ADIE);
+	running = 1;
+
+#ifdef SAMPLER_TIMER
+	timed = rate > 0;
+	if (timed) {
+		start_timer(rate * count);
+		sbi(ADCSRA, ADATE);
+		return;
+	}
+#endif
+	sbi(ADCSRA, ADSC);
+}
+
+void stopAnalogSampler(void)
+{
+	if (!running) return;
+	running = 0;
+
+	cbi(ADCSRA, ADIE);
+#ifdef SAMPLER_TIMER
+	if (timed) {
+		cbi(ADCSRA, ADATE);
+		// back to the PWM setup from init(), with the duty cycles
+		// analogWrite() had set on the timer's pins
+		TCCR1B = 0;
+		TCNT1 = 0;
+		OCR1A = saved_ocr1a;
+		OCR1B = saved_ocr1b;
+		TCCR1A = saved_tccr1a;
+		TCCR1B = saved_tccr1b;
+	}
+#endif
+	// let a conversion in progress finish, so analogRead() doesn't take
+	// its result
+	while (bit_is_set(ADCSRA, ADSC));
+}
+
+// the number of samples of pins[index] waiting to be read
+int analogSamplesAvailable(uint8_t index)
+{
+	if (index >= channel_count) return 0;
+	const struct sampler_channel *c = &channels[index];
+	int n = c->head - c->tail;
+	return n < 0 ? n + channel_size : n;
+}
+
+// moves up to length samples of pins[index] into buffer, oldest first, and
+// returns how many there were
+int readAnalogSamples(uint8_t index, int *buffer, int length)
+{
+	if (index >= channel_count) return 0;
+	struct sampler_channel *c = &channels[index];
+	uint8_t tail = c->tail;
+	int count = 0;
+	while (count < length && tail != c->head) {
+		buffer[count++] = samples[c->start + tail];
+		if (++tail == channel_size) tail = 0;
+	}
+	c->tail = tail;
+	return count;
+}
+
+unsigned int analogSamplerOverruns(void)
+{
+	uint8_t oldSREG = SREG;
+	cli();
+	unsigned int n = overruns;
+	SREG = oldSREG;
+	return n;
+}
+
+// starts adding up 4^(bits - 10) readings of the pin in the background,
+// for a result with the given number of bits (11 to 16)
+void startAnalogOversampling(uint8_t pin, uint8_t bits)
+{
+	uint8_t channel = analogInputChannel(pin);
+
+	stopAnalogSampler();
+	stop_oversampling();
+
+	if (bits < 10) bits = 10;
+	if (bits > 16) bits = 16;
+	oversample_shift = bits - 10;
+	oversample_sum = 0;
+
+#if defined(ADCSRB) && defined(MUX5)
+	ADCSRB = (ADCSRB & ~_BV(MUX5)) | (((channel >> 3) & 0x01) << MUX5);
+#endif
+	ADMUX = (analog_reference << 6) | (channel & 0x07);
+
+	oversample_left = 1 << (2 * oversample_shift);
+	sbi(ADCSRA, ADIF);
+	sbi(ADCSRA, ADIE);
+	sbi(ADCSRA, ADSC);
+}
+
+// the result of startAnalogOversampling(), or -1 while the readings are
+// still being taken
+long readAnalogOversampling(void)
+{
+	unsigned int left;
+	uint8_t oldSREG = SREG;
+
+	cli();
+	left = oversample_left;
+	SREG = oldSREG;
+
+	if (left) return -1;
+	return oversample_sum >> oversample_shift;
+}
+
+// as analogRead(), but with the given number of bits (11 to 16); calls
+// yield() while it waits
+long analogReadOversampled(uint8_t pin, uint8_t bits)
+{
+	long value;
+
+	startAnalogOversampling(pin, bits);
+	while ((value = readAnalogOversampling()) < 0)
+		yield();
+	return value;
+}
+
+#endif
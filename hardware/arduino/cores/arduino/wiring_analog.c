@@ -37,10 +37,31 @@ void analogReference(uint8_t mode)
 	analog_reference = mode;
 }
 
-int analogRead(uint8_t pin)
+// sets the ADC clock to the CPU clock divided by 2, 4, 8, 16, 32, 64 or
+// 128 (other values are rounded up to one of these).  init() divides by
+// 128, for a 125 kHz ADC clock at 16 MHz.  the ADC gives its full 10 bits
+// of accuracy with a clock of 50 to 200 kHz; a faster clock makes each
+// conversion (13 ADC clocks) quicker but less accurate.
+void analogPrescaler(uint8_t divisor)
 {
-	uint8_t low, high;
+#if defined(ADCSRA) && defined(ADPS0)
+	uint8_t bits = 1;
+	uint8_t oldSREG;
 
+	while (bits < 7 && (1 << bits) < divisor) bits++;
+
+	// leave ADIF alone: writing it back as 1 would clear it
+	oldSREG = SREG;
+	cli();
+	ADCSRA = (ADCSRA & ~(_BV(ADIF) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))) | bits;
+	SREG = oldSREG;
+#endif
+}
+
+// the ADC channel of an analog pin, given as a channel (0, 1, ...) or pin
+// (A0, A1, ...) number
+uint8_t analogInputChannel(uint8_t pin)
+{
 #if defined(analogPinToChannel)
 #if defined(__AVR_ATmega32U4__)
 	if (pin >= 18) pin -= 18; // allow for channel or pin numbers
@@ -55,6 +76,14 @@ int analogRead(uint8_t pin)
 #else
 	if (pin >= 14) pin -= 14; // allow for channel or pin numbers
 #endif
+	return pin;
+}
+
+int analogRead(uint8_t pin)
+{
+	uint8_t low, high;
+
+	pin = analogInputChannel(pin);
 
 #if defined(ADCSRB) && defined(MUX5)
 	// the MUX5 bit of ADCSRB selects whether we're reading from channels
@@ -0,0 +1,106 @@
+/*
+  wiring_cycles.c - clock cycle counter for precise timestamps
+  Part of Arduino - http://www.arduino.cc/
+
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#include "wiring_private.h"
+
+// micros() counts in steps of 64 clock cycles (4 microseconds at 16 MHz).
+// For finer timestamps, startCycleCounter() runs timer 1 at the full clock
+// rate and cycleCount() returns the number of cycles since; at 16 MHz that's
+// a resolution of 62.5 ns, and the count wraps around after 268 seconds.
+// Use clockCyclesToMicroseconds() to convert a difference of two counts.
+//
+// While the counter runs, timer 1 can't be used for anything else: PWM on
+// its pins (9 and 10 on the Uno) and libraries such as Servo won't work.
+// This file is only linked into sketches that use it, so it doesn't claim
+// the timer 1 overflow interrupt otherwise.
+
+#if defined(TCCR1A) && defined(TCCR1B) && defined(TCNT1)
+
+static volatile unsigned int cycle_overflows;
+static uint8_t saved_tccr1a, saved_tccr1b;
+
+ISR(TIMER1_OVF_vect)
+{
+	cycle_overflows++;
+}
+
+void startCycleCounter(void)
+{
+	uint8_t oldSREG = SREG;
+	cli();
+
+	saved_tccr1a = TCCR1A;
+	saved_tccr1b = TCCR1B;
+
+	// normal mode, no prescaling
+	TCCR1B = 0;
+	TCCR1A = 0;
+	TCNT1 = 0;
+	cycle_overflows = 0;
+#if defined(TIFR1)
+	TIFR1 = _BV(TOV1);
+	sbi(TIMSK1, TOIE1);
+#else
+	TIFR = _BV(TOV1);
+	sbi(TIMSK, TOIE1);
+#endif
+	TCCR1B = _BV(CS10);
+
+	SREG = oldSREG;
+}
+
+void stopCycleCounter(void)
+{
+#if defined(TIMSK1)
+	cbi(TIMSK1, TOIE1);
+#else
+	cbi(TIMSK, TOIE1);
+#endif
+	// back to the PWM setup from init()
+	TCCR1A = saved_tccr1a;
+	TCCR1B = saved_tccr1b;
+}
+
+unsigned long cycleCount(void)
+{
+	unsigned int h, t;
+	uint8_t oldSREG = SREG;
+
+	cli();
+	h = cycle_overflows;
+	t = TCNT1;
+
+	// an overflow that happened after interrupts were disabled is still
+	// pending; count it if the timer was read after it
+#if defined(TIFR1)
+	if ((TIFR1 & _BV(TOV1)) && t < 0x8000)
+#else
+	if ((TIFR & _BV(TOV1)) && t < 0x8000)
+#endif
+		h++;
+
+	SREG = oldSREG;
+
+	return ((unsigned long)h << 16) | t;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*
+  wiring_memory.c - heap and stack usage
+  Part of Arduino - http://www.arduino.cc/
+
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General
+  Public License along with this library; if not, write to the
+  Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+  Boston, MA  02111-1307  USA
+*/
+
+#include "wiring_private.h"
+#include "avr-libc/stdlib_private.h"
+
+// the heap grows up from __malloc_heap_start to __brkval (which is 0 until
+// the first allocation), and the stack grows down from RAMEND to SP.
+// freed blocks below __brkval are kept in a list by malloc().
+//
+// __flp and struct __freelist are private to malloc(): they're taken from
+// the avr-libc 1.8.0 malloc() that the core links in instead of the
+// toolchain's (see avr-libc/), so they must be checked again whenever that
+// copy is updated to a newer avr-libc.
+
+#define PAINT 0xa5
+
+static uint8_t *heapTop(void)
+{
+	return (uint8_t *)(__brkval ? __brkval : __malloc_heap_start);
+}
+
+// called by main() before anything else, while interrupts are still
+// disabled, so that nothing below the stack pointer is in use.  main() only
+// calls it when this file is linked in, i.e. when the sketch uses
+// memoryStats(), so other sketches don't spend their startup painting.
+void paintFreeMemory(void)
+{
+	uint8_t *p = heapTop();
+	uint8_t *end = (uint8_t *)SP;
+	while (p < end)
+		*p++ = PAINT;
+}
+
+MemoryStats memoryStats(void)
+{
+	MemoryStats stats;
+	uint8_t *start = (uint8_t *)__malloc_heap_start;
+	uint8_t *top = heapTop();
+	uint8_t *sp = (uint8_t *)SP;
+	size_t listed = 0, largest = 0, gap = sp - top;
+	struct __freelist *fp;
+	uint8_t *p, *run, *untouched, *untouchedEnd;
+
+	for (fp = __flp; fp; fp = fp->nx) {
+		listed += fp->sz + sizeof(size_t);
+		if (fp->sz > largest)
+			largest = fp->sz;
+	}
+	// malloc() keeps __malloc_margin bytes clear of the stack and needs
+	// room for the size of the block
+	if (gap > __malloc_margin + sizeof(size_t) &&
+	    gap - __malloc_margin - sizeof(size_t) > largest)
+		largest = gap - __malloc_margin - sizeof(size_t);
+
+	// the longest run of the paint between the heap and the stack is
+	// the memory neither has ever reached
+	untouched = untouchedEnd = top;
+	run = top;
+	for (p = top; p < sp; p++) {
+		if (*p != PAINT)
+			run = p + 1;
+		else if (p + 1 - run > untouchedEnd - untouched) {
+			untouched = run;
+			untouchedEnd = p + 1;
+		}
+	}
+	if (untouched == untouchedEnd)
+		untouchedEnd = sp + 1;  // no paint left: only the current sizes are known
+
+	stats.heapSize = top - start;
+	stats.heapPeak = (untouched > top ? untouched : top) - start;
+	stats.freeMemory = gap + listed;
+	stats.largestFreeBlock = largest;
+	stats.stackSize = RAMEND - (size_t)sp;
+	stats.stackPeak = RAMEND + 1 - (size_t)untouchedEnd;
+	if (stats.stackPeak < stats.stackSize)
+		stats.stackPeak = stats.stackSize;
+	return stats;
+}
@@ -64,6 +64,10 @@ extern "C"{
 
 typedef void (*voidFuncPtr)(void);
 
+// analog input settings shared by analogRead() and the sampler
+extern uint8_t analog_reference;
+uint8_t analogInputChannel(uint8_t pin);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
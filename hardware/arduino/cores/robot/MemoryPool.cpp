@@ -0,0 +1,71 @@
+/*
+  MemoryPool.cpp - fixed-size block pool and arena allocators
+  Copyright (c) 2013 Arduino Team.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "MemoryPool.h"
+
+// BlockPool ///////////////////////////////////////////////////////////////////
+
+BlockPool::BlockPool(void *memory, size_t size, size_t blockSize)
+{
+  // a free block has to hold the pointer to the next one
+  if (blockSize < sizeof(void *))
+    blockSize = sizeof(void *);
+
+  _blockSize = blockSize;
+  _available = size / blockSize;
+  _begin = (uint8_t *)memory;
+  _end = _begin + _available * blockSize;
+
+  // chain the blocks together, the first one at the head of the list
+  _free = NULL;
+  for (uint8_t *block = _end; block > _begin; ) {
+    block -= blockSize;
+    *(void **)block = _free;
+    _free = block;
+  }
+}
+
+void *BlockPool::allocate(void)
+{
+  void *block = _free;
+  if (block) {
+    _free = *(void **)block;
+    _available--;
+  }
+  return block;
+}
+
+void BlockPool::release(void *block)
+{
+  if (!block) return;
+  *(void **)block = _free;
+  _free = block;
+  _available++;
+}
+
+// Arena ///////////////////////////////////////////////////////////////////////
+
+void *Arena::allocate(size_t size)
+{
+  if (size > _size - _used)
+    return NULL;
+  void *p = _begin + _used;
+  _used += size;
+  return p;
+}
@@ -60,6 +60,12 @@ static const uint8_t A7 = 21;
 #define digitalPinToPCMSK(p)    (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : ((uint8_t *)0))))
 #define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
 
+// the port (as a letter) and bit of each digital pin, as in the tables
+// below, so that a constant pin number can be resolved at compile time
+// (see FastPin.h)
+#define digitalPinToPortLetter(p)  ("DDDDDDDDBBBBBBCCCCCC"[p])
+#define digitalPinToBit(p)         ("01234567012345012345"[p] - '0')
+
 #ifdef ARDUINO_MAIN
 
 // On the Arduino board, digital pins are also used
@@ -133,6 +133,12 @@ static const uint8_t A11 = 29;	// D12
 extern const uint8_t PROGMEM analog_pin_to_channel_PGM[];
 #define analogPinToChannel(P)  ( pgm_read_byte( analog_pin_to_channel_PGM + (P) ) )
 
+// the port (as a letter) and bit of each digital pin, as in the tables
+// below, so that a constant pin number can be resolved at compile time
+// (see FastPin.h)
+#define digitalPinToPortLetter(p)  ("DDDDDCDEBBBBDCBBBBFFFFFFDDBBBD"[p])
+#define digitalPinToBit(p)         ("231046764567673120765410474566"[p] - '0')
+
 #ifdef ARDUINO_MAIN
 
 // On the Arduino board, digital pins are also used
@@ -83,6 +83,12 @@ static const uint8_t A15 = 69;
                                 ( (((p) >= 62) && ((p) <= 69)) ? ((p) - 62) : \
                                 0 ) ) ) ) ) )
 
+// the port (as a letter) and bit of each digital pin, as in the tables
+// below, so that a constant pin number can be resolved at compile time
+// (see FastPin.h)
+#define digitalPinToPortLetter(p)  ("EEEEGEHHHHBBBBJJHHDDDDAAAAAAAACCCCCCCCDGGGLLLLLLLLBBBBFFFFFFFFKKKKKKKK"[p])
+#define digitalPinToBit(p)         ("0145533456456710103210012345677654321072107654321032100123456701234567"[p] - '0')
+
 #ifdef ARDUINO_MAIN
 
 const uint16_t PROGMEM port_to_mode_PGM[] = {
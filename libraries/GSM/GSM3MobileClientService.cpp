@@ -199,18 +199,19 @@ int GSM3MobileClientService::available()
 
 int GSM3MobileClientService::read(uint8_t *buf, size_t size)
 {
-	int i;
-	uint8_t c;
+	size_t i;
 	
+	// read() returns 0 both for a 0x00 byte and when there's nothing left,
+	// so ask available() (1 while there's data) before each byte instead
 	for(i=0;i<size;i++)
 	{
-		c=read();
-		if(c==0)
+		if(available()!=1)
 			break;
-		buf[i]=c;
+		buf[i]=(uint8_t)read();
 	}
 	
-	return i;
+	// -1 if nothing was available, as Stream::read(buf, size) expects
+	return i ? (int)i : -1;
 /* This is the old implementation, testing a simpler one
 	int res;
 	// If we were writing, just stop doing it.
@@ -123,7 +123,7 @@ class GSM3MobileClientService : public Client
 		/** Read from response buffer and copy size specified to buffer
 			@param buf			Buffer		
 			@param size			Buffer size
-			@return bytes read
+			@return bytes read, or -1 if none were available
 		 */
 		int read(uint8_t *buf, size_t size);
 		
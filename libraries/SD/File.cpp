@@ -13,14 +13,21 @@
  */
 
 #include <SD.h>
+#include <MemoryPool.h>
 
 /* for debugging file open/close leaks
    uint8_t nfilecount=0;
 */
 
+BlockPool *File::_pool = NULL;
+
 File::File(SdFile f, const char *n) {
   // oh man you are kidding me, new() doesnt exist? Ok we do it by hand!
-  _file = (SdFile *)malloc(sizeof(SdFile)); 
+  _file = 0;
+  if (_pool && _pool->blockSize() >= sizeof(SdFile))
+    _file = (SdFile *)_pool->allocate();
+  if (!_file)
+    _file = (SdFile *)malloc(sizeof(SdFile)); 
   if (_file) {
     memcpy(_file, &f, sizeof(SdFile));
     
@@ -95,6 +102,10 @@ int File::read(void *buf, uint16_t nbyte) {
   return 0;
 }
 
+int File::read(uint8_t *buf, size_t nbyte) {
+  return read((void *)buf, nbyte);
+}
+
 int File::available() {
   if (! _file) return 0;
 
@@ -127,7 +138,10 @@ uint32_t File::size() {
 void File::close() {
   if (_file) {
     _file->close();
-    free(_file); 
+    if (_pool && _pool->owns(_file))
+      _pool->release(_file);
+    else
+      free(_file); 
     _file = 0;
 
     /* for debugging file open/close leaks
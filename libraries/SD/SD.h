@@ -20,6 +20,8 @@
 #include <utility/SdFat.h>
 #include <utility/SdFatUtil.h>
 
+class BlockPool;
+
 #define FILE_READ O_READ
 #define FILE_WRITE (O_READ | O_WRITE | O_CREAT)
 
@@ -27,6 +29,7 @@ class File : public Stream {
  private:
   char _name[13]; // our name
   SdFile *_file;  // underlying file pointer
+  static BlockPool *_pool;  // where open files are allocated, NULL for the heap
 
 public:
   File(SdFile f, const char *name);     // wraps an underlying SdFile
@@ -38,6 +41,7 @@ public:
   virtual int available();
   virtual void flush();
   int read(void *buf, uint16_t nbyte);
+  virtual int read(uint8_t *buf, size_t nbyte);
   boolean seek(uint32_t pos);
   uint32_t position();
   uint32_t size();
@@ -50,6 +54,12 @@ public:
   void rewindDirectory(void);
   
   using Print::write;
+
+  // allocate open files from blocks of the given pool (which must be at
+  // least sizeof(SdFile) bytes), using the heap only when it's empty.
+  // NULL, the default, goes back to the heap.  don't change it while
+  // files are open.
+  static void setPool(BlockPool *pool) { _pool = pool; }
 };
 
 class SDClass {
@@ -123,9 +123,15 @@ int WiFiClient::read() {
 
 
 int WiFiClient::read(uint8_t* buf, size_t size) {
-  if (!ServerDrv::getDataBuf(_sock, buf, &size))
-      return -1;
-  return 0;
+  // the shield's block read has no length: it sends everything it has
+  // buffered, which may be more than size, so read a byte at a time
+  size_t count = 0;
+  while (count < size) {
+    int c = read();
+    if (c < 0) break;
+    buf[count++] = c;
+  }
+  return count > 0 ? (int)count : -1;
 }
 
 int WiFiClient::peek() {
@@ -131,16 +131,16 @@ int WiFiUDP::read()
 
 int WiFiUDP::read(unsigned char* buffer, size_t len)
 {
-  if (available())
-  {
-	  size_t size = 0;
-	  if (!ServerDrv::getDataBuf(_sock, buffer, &size))
-		  return -1;
-	  // TODO check if the buffer is too smal respect to buffer size
-	  return size;
-  }else{
-	  return -1;
+  // the shield's block read has no length: it sends everything it has
+  // buffered, which may be more than len, so read a byte at a time (as
+  // WiFiClient does)
+  size_t count = 0;
+  while (count < len) {
+    int c = read();
+    if (c < 0) break;
+    buffer[count++] = c;
   }
+  return count > 0 ? (int)count : -1;
 }
 
 int WiFiUDP::peek()
@@ -221,6 +221,21 @@ int TwoWire::read(void)
   return value;
 }
 
+// must be called in:
+// slave rx event callback
+// or after requestFrom(address, numBytes)
+int TwoWire::read(uint8_t *data, size_t quantity)
+{
+  size_t count = rxBufferLength - rxBufferIndex;
+  if(quantity < count){
+    count = quantity;
+  }
+  memcpy(data, rxBuffer + rxBufferIndex, count);
+  rxBufferIndex += count;
+
+  return count;
+}
+
 // must be called in:
 // slave rx event callback
 // or after requestFrom(address, numBytes)